@@ -26,16 +26,79 @@
 
 #include <fstream>
 #include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
 
 #include <ilang/ila/instr_lvl_abs.h>
 #include <ilang/target-sc/ila_sim.h>
 #include <ilang/util/log.h>
 
 #include <relay/relay_top.h>
+#include <relay/relay_vector_op.h>
 
 using namespace ilang;
 
-int main() {
+// swap the std::map memory states of the generated simulator for
+// relay_paged_mem (uninterpreted_func/relay_paged_mem.h); IlaSim has no
+// memory backend option, so the generated header is rewritten in place
+bool UsePagedMemory(const std::string& sim_gen_dir) {
+  auto header_path = sim_gen_dir + "/include/relay_sim.h";
+  std::ifstream fin(header_path);
+  if (!fin.is_open()) {
+    ILA_ERROR << "cannot open " << header_path;
+    return false;
+  }
+  std::stringstream buf;
+  buf << fin.rdbuf();
+  fin.close();
+  auto header = buf.str();
+
+  for (auto mem : {RELAY_MEMORY, RELAY_TENSOR_MEM}) {
+    std::regex decl("std::map<\\s*int\\s*,\\s*(.+?)\\s*>\\s+(relay_sim_" +
+                    std::string(mem) + ")\\s*;");
+    if (!std::regex_search(header, decl)) {
+      ILA_WARN << "no std::map declaration of " << mem << " in "
+               << header_path << ", left unchanged";
+      continue;
+    }
+    header = std::regex_replace(header, decl, "relay_paged_mem<$1> $2;");
+  }
+
+  auto pos = header.find("#include");
+  if (pos == std::string::npos) {
+    pos = 0;
+  }
+  header.insert(pos, "#include \"relay_paged_mem.h\"\n");
+
+  std::ofstream fout(header_path);
+  fout << header;
+  fout.close();
+
+  // install the backend next to the generated header
+  std::ifstream src(RELAY_PAGED_MEM_HEADER, std::ios::binary);
+  std::ofstream dst(sim_gen_dir + "/include/relay_paged_mem.h",
+                    std::ios::binary);
+  if (!src.is_open() || !dst.is_open()) {
+    ILA_ERROR << "cannot install " << RELAY_PAGED_MEM_HEADER;
+    return false;
+  }
+  dst << src.rdbuf();
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  // --paged-mem: back the memory states with a lazily allocated flat array
+  bool paged_mem = false;
+  for (auto i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "--paged-mem") {
+      paged_mem = true;
+    } else {
+      ILA_ERROR << "unknown option " << argv[i];
+      return 1;
+    }
+  }
+
   // get the ILA model
   auto relay = relay::GetRelayIla("relay_sim");
 
@@ -59,5 +122,9 @@ int main() {
   simulator_generator.enable_cmake_support();
   simulator_generator.sim_gen(sim_gen_dir, false, true, false);
 
+  if (paged_mem && !UsePagedMemory(sim_gen_dir)) {
+    return 1;
+  }
+
   return 0;
 }
@@ -1,7 +1,19 @@
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <systemc.h>
 #include <relay_sim.h>
@@ -14,34 +26,250 @@
 #define WORD_ADDR(__byte_addr) ((__byte_addr) / WORD_SIZE)
 
 #define PRINT_BIN false
-#define READ_WORDS(__fstream, __num_words, __map, __word_cntr) do{ \
-            char __word_buf[WORD_SIZE]; \
-            if (PRINT_BIN) std::cout<<"READING "<<__num_words<<" words....\n";\
-            for (int __idx = 0; __idx < (__num_words); __idx++) { \
-              (__fstream).read(__word_buf, WORD_SIZE); \
-              unsigned int __word_val = *(unsigned int*)__word_buf;\
-              float __fp_val = *(float*)__word_buf;\
-              if (PRINT_BIN) {std::cout<<"\tread "<<WORD_SIZE<<" bytes: 0x"<<hex<<__word_val<<dec<<" float: "<<std::setprecision(6)<<__fp_val<<"\n";\
-              } (__map)[(__word_cntr)] = __word_val; \
-              (__word_cntr) ++; \
-            }} while(false)
+
+// clock cycles a function call may take before it is reported as timed out,
+// default of relay_sim -c
+#define RUN_MAX_CYCLES 10000000
+// lstm.bin sections, in the order they are placed in relay_memory; the
+// reference section is the expected next_hidden
+enum {
+  LSTM_BIN_INPUT,
+  LSTM_BIN_CELL,
+  LSTM_BIN_HIDDEN,
+  LSTM_BIN_I2H_WEIGHT,
+  LSTM_BIN_H2H_WEIGHT,
+  LSTM_BIN_I2H_BIAS,
+  LSTM_BIN_H2H_BIAS,
+  LSTM_BIN_REFERENCE,
+  LSTM_BIN_SECTIONS
+};
+
+// sectioned lstm.bin (script/lstm_test.py), all fields little-endian uint32:
+//   magic, version, in_sz, out_sz, num_sections,
+//   num_sections x {section id, byte offset, num words}
+// a file without the magic is the legacy layout: in_sz, out_sz, then the
+// sections back to back in LSTM_BIN_* order
+#define LSTM_BIN_MAGIC 0x59414c52 // "RLAY"
+#define LSTM_BIN_VERSION 1
+#define LSTM_BIN_HEADER_WORDS 5
+#define LSTM_BIN_ENTRY_WORDS 3
+// upper bound of in_sz/out_sz, keeps the relay_memory layout of run_lstm
+// (about 4*out_sz*(in_sz+out_sz) words) inside the 32-bit byte addresses
+#define LSTM_BIN_MAX_SIZE 8192
+
+struct lstm_bin_section {
+  const uint32_t* data;
+  size_t num_words;
+};
 
 
 
 int in_sz, out_sz;
 unsigned int next_cell_addr, next_hidden_addr;
-std::ifstream file;
+// results drained through func_data_out
+std::vector<unsigned int> next_cell_out, next_hidden_out;
+bool readback_done = false;
+// cycles and instructions of the last function call
+long last_cycles = 0;
+long last_instrs = 0;
+// relay_memory loaded by testbench::run, the source starts calling after that
+bool memory_loaded = false;
+sc_event readback_event;
+
+// lstm.bin is mmapped, the sections point into the mapping
+void* lstm_bin_map = MAP_FAILED;
+size_t lstm_bin_size = 0;
+lstm_bin_section lstm_sections[LSTM_BIN_SECTIONS];
+
+// relay_sim -c <cycles>, 0 waits for relay_func_done without a limit
+long run_max_cycles = RUN_MAX_CYCLES;
+
+// words of a section, in_sz and out_sz are bounded by LSTM_BIN_MAX_SIZE
+size_t lstm_section_words(int id) {
+  size_t in = in_sz, out = out_sz;
+  switch (id) {
+    case LSTM_BIN_INPUT: return in;
+    case LSTM_BIN_I2H_WEIGHT: return 4 * out * in;
+    case LSTM_BIN_H2H_WEIGHT: return 4 * out * out;
+    case LSTM_BIN_I2H_BIAS:
+    case LSTM_BIN_H2H_BIAS: return 4 * out;
+    default: return out;
+  }
+}
+
+bool lstm_bin_sizes(const char* path, uint32_t in, uint32_t out) {
+  if (in == 0 || out == 0 || in > LSTM_BIN_MAX_SIZE ||
+      out > LSTM_BIN_MAX_SIZE) {
+    std::cerr << path << ": sizes " << in << " x " << out
+              << " out of range (1 to " << LSTM_BIN_MAX_SIZE << ")\n";
+    return false;
+  }
+  in_sz = in;
+  out_sz = out;
+  return true;
+}
+
+void unmap_lstm_bin() {
+  if (lstm_bin_map != MAP_FAILED) {
+    munmap(lstm_bin_map, lstm_bin_size);
+    lstm_bin_map = MAP_FAILED;
+  }
+}
+
+// header and section table of the mapped file
+bool parse_lstm_bin(const char* path) {
+  const uint32_t* words = (const uint32_t*)lstm_bin_map;
+  size_t file_words = lstm_bin_size / WORD_SIZE;
+  for (int i = 0; i < LSTM_BIN_SECTIONS; i++) {
+    lstm_sections[i].data = nullptr;
+    lstm_sections[i].num_words = 0;
+  }
+
+  if (words[0] == LSTM_BIN_MAGIC) {
+    if (file_words < LSTM_BIN_HEADER_WORDS || words[1] != LSTM_BIN_VERSION) {
+      std::cerr << path << ": unsupported header\n";
+      return false;
+    }
+    if (!lstm_bin_sizes(path, words[2], words[3])) {
+      return false;
+    }
+    size_t num_sections = words[4];
+    if (file_words <
+        LSTM_BIN_HEADER_WORDS + num_sections * LSTM_BIN_ENTRY_WORDS) {
+      std::cerr << path << ": truncated header\n";
+      return false;
+    }
+    for (size_t i = 0; i < num_sections; i++) {
+      const uint32_t* entry =
+          words + LSTM_BIN_HEADER_WORDS + i * LSTM_BIN_ENTRY_WORDS;
+      uint32_t id = entry[0], offset = entry[1], num_words = entry[2];
+      if (id >= LSTM_BIN_SECTIONS) {
+        continue; // unknown section, skipped
+      }
+      if (offset % WORD_SIZE != 0 ||
+          offset / WORD_SIZE + (size_t)num_words > file_words) {
+        std::cerr << path << ": section " << id << " out of the file\n";
+        return false;
+      }
+      lstm_sections[id].data = words + offset / WORD_SIZE;
+      lstm_sections[id].num_words = num_words;
+    }
+  } else {
+    if (!lstm_bin_sizes(path, words[0], words[1])) {
+      return false;
+    }
+    size_t offset = 2;
+    for (int i = 0; i < LSTM_BIN_SECTIONS; i++) {
+      size_t num_words = lstm_section_words(i);
+      if (offset + num_words > file_words) {
+        std::cerr << path << ": truncated legacy file\n";
+        return false;
+      }
+      lstm_sections[i].data = words + offset;
+      lstm_sections[i].num_words = num_words;
+      offset += num_words;
+    }
+  }
+
+  for (int i = 0; i < LSTM_BIN_SECTIONS; i++) {
+    if (lstm_sections[i].num_words != lstm_section_words(i)) {
+      std::cerr << path << ": section " << i << " has "
+                << lstm_sections[i].num_words << " words, expected "
+                << lstm_section_words(i) << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// map path and point lstm_sections into it; on failure nothing stays mapped
+// and the file is closed
+bool map_lstm_bin(const char* path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "cannot open " << path << "\n";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    std::cerr << "cannot stat " << path << "\n";
+    close(fd);
+    return false;
+  }
+  lstm_bin_size = st.st_size;
+  if (lstm_bin_size >= 2 * WORD_SIZE) {
+    lstm_bin_map = mmap(nullptr, lstm_bin_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (lstm_bin_map == MAP_FAILED) {
+    std::cerr << "cannot map " << path << "\n";
+    return false;
+  }
+  madvise(lstm_bin_map, lstm_bin_size, MADV_SEQUENTIAL);
+
+  bool ok = parse_lstm_bin(path);
+  if (!ok) {
+    unmap_lstm_bin();
+  }
+  return ok;
+}
+
+// cases of the run, all simulated in one sc_start session: lstm.bin by
+// default, or the lines of a manifest (relay_sim -m <manifest>)
+struct sim_case {
+  std::string name;
+  std::string path;
+};
+std::vector<sim_case> sim_cases;
+
+// manifest: one case per line, "<lstm.bin path> [name]", # starts a comment
+bool read_manifest(const char* path) {
+  std::ifstream manifest(path);
+  if (!manifest.is_open()) {
+    std::cerr << "cannot open " << path << "\n";
+    return false;
+  }
+  std::string line;
+  while (std::getline(manifest, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    sim_case c;
+    if (!(fields >> c.path)) {
+      continue;
+    }
+    if (!(fields >> c.name)) {
+      c.name = c.path;
+    }
+    sim_cases.push_back(c);
+  }
+  return !sim_cases.empty();
+}
+
+// copy a section from the mapping into the memory state, word by word since
+// the generated memory is keyed by word address
+template <class Mem>
+void load_words(Mem& mem, const lstm_bin_section& section, int& word_cntr) {
+  if (PRINT_BIN) std::cout<<"LOADING "<<section.num_words<<" words....\n";
+  for (size_t i = 0; i < section.num_words; i++) {
+    mem[word_cntr + i] = section.data[i];
+  }
+  word_cntr += section.num_words;
+}
 // source module of the testbench
 // creating signals for relay_sim model
 SC_MODULE(Source) {
   sc_in<bool> clk{"clk"};
   //sc_in<bool> rst;
 
+  // the model, only the relay_data_out register and the state of the running
+  // function are read
+  relay_sim* model = nullptr;
+
   sc_out< sc_biguint<1> > relay_sim_relay_func_run_in_in;
   sc_out< sc_biguint<8> > relay_sim_relay_func_id_in;
   sc_out< sc_biguint<8> > relay_sim_relay_data_in_in;
-  sc_out< sc_biguint<8> > relay_sim_data_in_batch_in;
-  sc_out< sc_biguint<8> > relay_sim_data_in_channel_in;
+  sc_out< sc_biguint<32> > relay_sim_data_in_batch_in;
+  sc_out< sc_biguint<32> > relay_sim_data_in_channel_in;
   sc_out< sc_biguint<32> > relay_sim_data_in_y_in;
   sc_out< sc_biguint<32> > relay_sim_data_in_x_in;
   sc_out< sc_biguint<8> > relay_sim_pool_size_y_in;
@@ -52,6 +280,7 @@ SC_MODULE(Source) {
   sc_out< sc_biguint<8> > relay_sim_padding_in_x_in;
   sc_out< sc_biguint<8> > relay_sim_layout_in_in;
   sc_out< sc_biguint<8> > relay_sim_ceil_mode_in_in;
+  sc_out< sc_biguint<8> > relay_sim_maxpooling_mode_in_in;
 
 
   sc_out< sc_biguint<32> > relay_sim_relay_lstm_in_size_in;
@@ -68,6 +297,44 @@ SC_MODULE(Source) {
   sc_out< sc_biguint<32> > relay_sim_relay_lstm_temp_vector0_addr_in;
   sc_out< sc_biguint<32> > relay_sim_relay_lstm_temp_vector1_addr_in;
   sc_out< sc_biguint<32> > relay_sim_relay_lstm_temp_vector2_addr_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_lstm_seq_len_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_lstm_input_stride_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_lstm_hidden_stride_in;
+
+  // nn dense
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_in_size_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_out_size_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_batch_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_input_addr_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_weight_addr_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_bias_addr_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_output_addr_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_input_stride_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_output_stride_in;
+  sc_out< sc_biguint<1> > relay_sim_relay_nn_dense_accumulate_in;
+  sc_out< sc_biguint<1> > relay_sim_relay_nn_dense_skip_bias_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_nn_dense_block_in;
+
+  // vector op
+  sc_out< sc_biguint<8> > relay_sim_relay_vector_func_opcode_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_vector_func_size_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_vector_func_op0_addr_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_vector_func_op1_addr_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_vector_func_output_addr_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_vector_func_op0_stride_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_vector_func_op1_stride_in;
+  sc_out< sc_biguint<32> > relay_sim_relay_vector_func_output_stride_in;
+
+  // burst tensor store
+  sc_out< sc_biguint<128> > relay_sim_relay_data_in_wide_in;
+  sc_out< sc_biguint<8> > relay_sim_relay_burst_len_in_in;
+  sc_out< sc_biguint<8> > relay_sim_relay_data_out_mem_in_in;
+
+  // maxpooling output placement
+  sc_out< sc_biguint<32> > relay_sim_maxpooling_out_base_in_in;
+  sc_out< sc_biguint<32> > relay_sim_maxpooling_out_row_stride_in_in;
+  sc_out< sc_biguint<32> > relay_sim_maxpooling_out_plane_stride_in_in;
+  sc_out< sc_biguint<32> > relay_sim_maxpooling_in_plane_stride_in_in;
   
   
 
@@ -95,6 +362,7 @@ SC_MODULE(Source) {
     relay_sim_padding_in_x_in = 0;
     relay_sim_layout_in_in = 0;
     relay_sim_ceil_mode_in_in = 0;
+    relay_sim_maxpooling_mode_in_in = 0;
 
     // reset inpusts for lstm
 
@@ -112,12 +380,68 @@ SC_MODULE(Source) {
     relay_sim_relay_lstm_temp_vector0_addr_in= 0;
     relay_sim_relay_lstm_temp_vector1_addr_in= 0;
     relay_sim_relay_lstm_temp_vector2_addr_in= 0;
+    relay_sim_relay_lstm_seq_len_in = 0;
+    relay_sim_relay_lstm_input_stride_in = 0;
+    relay_sim_relay_lstm_hidden_stride_in = 0;
+
+    // reset inputs for nn dense
+    relay_sim_relay_nn_dense_in_size_in = 0;
+    relay_sim_relay_nn_dense_out_size_in = 0;
+    relay_sim_relay_nn_dense_batch_in = 0;
+    relay_sim_relay_nn_dense_input_addr_in = 0;
+    relay_sim_relay_nn_dense_weight_addr_in = 0;
+    relay_sim_relay_nn_dense_bias_addr_in = 0;
+    relay_sim_relay_nn_dense_output_addr_in = 0;
+    relay_sim_relay_nn_dense_input_stride_in = 0;
+    relay_sim_relay_nn_dense_output_stride_in = 0;
+    relay_sim_relay_nn_dense_accumulate_in = 0;
+    relay_sim_relay_nn_dense_skip_bias_in = 0;
+    relay_sim_relay_nn_dense_block_in = 0;
+
+    // reset inputs for vector op
+    relay_sim_relay_vector_func_opcode_in = 0;
+    relay_sim_relay_vector_func_size_in = 0;
+    relay_sim_relay_vector_func_op0_addr_in = 0;
+    relay_sim_relay_vector_func_op1_addr_in = 0;
+    relay_sim_relay_vector_func_output_addr_in = 0;
+    relay_sim_relay_vector_func_op0_stride_in = 0;
+    relay_sim_relay_vector_func_op1_stride_in = 0;
+    relay_sim_relay_vector_func_output_stride_in = 0;
+
+    // reset inputs for burst tensor store
+    relay_sim_relay_data_in_wide_in = 0;
+    relay_sim_relay_burst_len_in_in = 0;
+    relay_sim_relay_data_out_mem_in_in = 0;
+
+    // reset inputs for maxpooling output placement
+    relay_sim_maxpooling_out_base_in_in = 0;
+    relay_sim_maxpooling_out_row_stride_in_in = 0;
+    relay_sim_maxpooling_out_plane_stride_in_in = 0;
+    relay_sim_maxpooling_in_plane_stride_in_in = 0;
+
+    // one LSTM call for each case loaded by testbench::run
+    while (true) {
+      while (!memory_loaded) {
+        wait(clk.posedge_event());
+      }
+      memory_loaded = false;
+      reset_funcs();
+      run_lstm();
+    }
+  }
 
-    wait(10, SC_NS);
+  // func_reset before every case, so that no control state of the previous
+  // case (a flag left on by a timed out call) carries over
+  void reset_funcs() {
+    relay_sim_relay_func_id_in = 11; // F_RESET_ID in relay_func_call.h
+    relay_sim_relay_func_run_in_in = 1;
+    wait(clk.posedge_event());
+    relay_sim_relay_func_run_in_in = 0;
+  }
 
+  void run_lstm() {
     /** generating input for LSTM  **/
 
-    relay_sim_relay_func_run_in_in = 1;
     relay_sim_relay_func_id_in = 3; // F_LSTM_ID in relay_func_call.h
 
     relay_sim_relay_lstm_in_size_in= in_sz;
@@ -162,9 +486,79 @@ SC_MODULE(Source) {
     next_hidden_addr = base_addr;
     INC_ADDR_BY_WORDS(base_addr, out_sz);
 
+    // single timestep
+    relay_sim_relay_lstm_seq_len_in = 1;
+    relay_sim_relay_lstm_input_stride_in = 0;
+    relay_sim_relay_lstm_hidden_stride_in = 0;
+
     cout << "source created for testbench" << endl;
 
-    wait(50, SC_NS);
+    if (run_until_done("lstm", run_max_cycles)) {
+      read_words(next_cell_addr, out_sz, next_cell_out);
+      read_words(next_hidden_addr, out_sz, next_hidden_out);
+    }
+    readback_done = true;
+    readback_event.notify();
+  }
+
+  // issue the call set up on the ports and advance clock by clock until
+  // relay_func_done, then report the cycles and the executed instructions
+  // (entries of relay_instr.log)
+  bool run_until_done(const char* name, long max_cycles) {
+    model->instr_log.flush();
+    std::streamoff log_start = model->instr_log.tellp();
+
+    relay_sim_relay_func_run_in_in = 1;
+    long cycles = 0;
+    bool done = false;
+    while (!done && (max_cycles == 0 || cycles < max_cycles)) {
+      wait(clk.posedge_event());
+      cycles++;
+      done = (model->relay_sim_relay_func_done.to_uint() == 1);
+    }
+    relay_sim_relay_func_run_in_in = 0;
+
+    last_cycles = cycles;
+    last_instrs = count_instrs(log_start);
+    std::cout << "@" << sc_time_stamp() << " " << name
+              << (done ? " done" : " timed out") << " after " << dec << cycles
+              << " cycles, " << last_instrs << " instructions" << std::endl;
+    return done;
+  }
+
+  // instruction entries logged after byte offset start
+  long count_instrs(std::streamoff start) {
+    model->instr_log.flush();
+    std::ifstream log("relay_instr.log");
+    log.seekg(start < 0 ? 0 : start);
+    long instrs = 0;
+    std::string line;
+    while (std::getline(log, line)) {
+      if (line.compare(0, 9, "Instr No.") == 0) {
+        instrs++;
+      }
+    }
+    return instrs;
+  }
+
+  // read num_words words of relay_memory from byte address addr, 16 bytes
+  // per func_data_out call
+  void read_words(unsigned int addr, int num_words,
+                  std::vector<unsigned int>& out) {
+    relay_sim_relay_func_run_in_in = 1;
+    relay_sim_relay_func_id_in = 10; // F_DATA_OUT_ID in relay_func_call.h
+    relay_sim_relay_data_out_mem_in_in = 1; // relay_memory
+    for (int i = 0; i < num_words; i += 4) {
+      int words = std::min(4, num_words - i);
+      relay_sim_data_in_y_in = addr + i * WORD_SIZE;
+      relay_sim_relay_burst_len_in_in = words * WORD_SIZE;
+      wait(clk.posedge_event());
+      sc_biguint<128> line = model->relay_sim_relay_data_out;
+      for (int k = 0; k < words; k++) {
+        out.push_back(line.range(32 * k + 31, 32 * k).to_uint());
+      }
+    }
+    relay_sim_relay_func_run_in_in = 0;
   }
 };
 
@@ -178,8 +572,8 @@ SC_MODULE(testbench) {
   sc_signal< sc_biguint<1> > relay_sim_relay_func_run_in_signal;
   sc_signal< sc_biguint<8> > relay_sim_relay_func_id_signal;
   sc_signal< sc_biguint<8> > relay_sim_relay_data_in_signal;
-  sc_signal< sc_biguint<8> > relay_sim_data_in_batch_signal;
-  sc_signal< sc_biguint<8> > relay_sim_data_in_channel_signal;
+  sc_signal< sc_biguint<32> > relay_sim_data_in_batch_signal;
+  sc_signal< sc_biguint<32> > relay_sim_data_in_channel_signal;
   sc_signal< sc_biguint<32> > relay_sim_data_in_y_signal;
   sc_signal< sc_biguint<32> > relay_sim_data_in_x_signal;
   sc_signal< sc_biguint<8> > relay_sim_pool_size_y_signal;
@@ -190,6 +584,7 @@ SC_MODULE(testbench) {
   sc_signal< sc_biguint<8> > relay_sim_padding_in_x_signal;
   sc_signal< sc_biguint<8> > relay_sim_layout_in_signal;
   sc_signal< sc_biguint<8> > relay_sim_ceil_mode_in_signal;
+  sc_signal< sc_biguint<8> > relay_sim_maxpooling_mode_in_signal;
 
 
   // lstm signals
@@ -207,6 +602,44 @@ SC_MODULE(testbench) {
   sc_signal< sc_biguint<32> > relay_sim_relay_lstm_temp_vector0_addr_in_signal;
   sc_signal< sc_biguint<32> > relay_sim_relay_lstm_temp_vector1_addr_in_signal;
   sc_signal< sc_biguint<32> > relay_sim_relay_lstm_temp_vector2_addr_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_lstm_seq_len_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_lstm_input_stride_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_lstm_hidden_stride_in_signal;
+
+  // nn dense signals
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_in_size_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_out_size_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_batch_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_input_addr_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_weight_addr_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_bias_addr_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_output_addr_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_input_stride_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_output_stride_in_signal;
+  sc_signal< sc_biguint<1> > relay_sim_relay_nn_dense_accumulate_in_signal;
+  sc_signal< sc_biguint<1> > relay_sim_relay_nn_dense_skip_bias_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_nn_dense_block_in_signal;
+
+  // vector op signals
+  sc_signal< sc_biguint<8> > relay_sim_relay_vector_func_opcode_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_vector_func_size_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_vector_func_op0_addr_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_vector_func_op1_addr_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_vector_func_output_addr_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_vector_func_op0_stride_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_vector_func_op1_stride_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_relay_vector_func_output_stride_in_signal;
+
+  // burst tensor store signals
+  sc_signal< sc_biguint<128> > relay_sim_relay_data_in_wide_in_signal;
+  sc_signal< sc_biguint<8> > relay_sim_relay_burst_len_in_in_signal;
+  sc_signal< sc_biguint<8> > relay_sim_relay_data_out_mem_in_in_signal;
+
+  // maxpooling output placement signals
+  sc_signal< sc_biguint<32> > relay_sim_maxpooling_out_base_in_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_maxpooling_out_row_stride_in_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_maxpooling_out_plane_stride_in_in_signal;
+  sc_signal< sc_biguint<32> > relay_sim_maxpooling_in_plane_stride_in_in_signal;
   
 
   testbench(sc_module_name name)
@@ -217,6 +650,7 @@ SC_MODULE(testbench) {
     {
     // binding the signals from the source
     src.clk(clk);
+    src.model = &relay;
 
     src.relay_sim_relay_func_run_in_in(relay_sim_relay_func_run_in_signal);
     src.relay_sim_relay_func_id_in(relay_sim_relay_func_id_signal);
@@ -233,6 +667,7 @@ SC_MODULE(testbench) {
     src.relay_sim_padding_in_x_in(relay_sim_padding_in_x_signal);
     src.relay_sim_layout_in_in(relay_sim_layout_in_signal);
     src.relay_sim_ceil_mode_in_in(relay_sim_ceil_mode_in_signal);
+    src.relay_sim_maxpooling_mode_in_in(relay_sim_maxpooling_mode_in_signal);
 
     // bind lstm signals from Source
 
@@ -250,6 +685,44 @@ SC_MODULE(testbench) {
     src.relay_sim_relay_lstm_temp_vector0_addr_in(relay_sim_relay_lstm_temp_vector0_addr_in_signal);
     src.relay_sim_relay_lstm_temp_vector1_addr_in(relay_sim_relay_lstm_temp_vector1_addr_in_signal);
     src.relay_sim_relay_lstm_temp_vector2_addr_in(relay_sim_relay_lstm_temp_vector2_addr_in_signal);
+    src.relay_sim_relay_lstm_seq_len_in(relay_sim_relay_lstm_seq_len_in_signal);
+    src.relay_sim_relay_lstm_input_stride_in(relay_sim_relay_lstm_input_stride_in_signal);
+    src.relay_sim_relay_lstm_hidden_stride_in(relay_sim_relay_lstm_hidden_stride_in_signal);
+
+    // bind nn dense signals from Source
+    src.relay_sim_relay_nn_dense_in_size_in(relay_sim_relay_nn_dense_in_size_in_signal);
+    src.relay_sim_relay_nn_dense_out_size_in(relay_sim_relay_nn_dense_out_size_in_signal);
+    src.relay_sim_relay_nn_dense_batch_in(relay_sim_relay_nn_dense_batch_in_signal);
+    src.relay_sim_relay_nn_dense_input_addr_in(relay_sim_relay_nn_dense_input_addr_in_signal);
+    src.relay_sim_relay_nn_dense_weight_addr_in(relay_sim_relay_nn_dense_weight_addr_in_signal);
+    src.relay_sim_relay_nn_dense_bias_addr_in(relay_sim_relay_nn_dense_bias_addr_in_signal);
+    src.relay_sim_relay_nn_dense_output_addr_in(relay_sim_relay_nn_dense_output_addr_in_signal);
+    src.relay_sim_relay_nn_dense_input_stride_in(relay_sim_relay_nn_dense_input_stride_in_signal);
+    src.relay_sim_relay_nn_dense_output_stride_in(relay_sim_relay_nn_dense_output_stride_in_signal);
+    src.relay_sim_relay_nn_dense_accumulate_in(relay_sim_relay_nn_dense_accumulate_in_signal);
+    src.relay_sim_relay_nn_dense_skip_bias_in(relay_sim_relay_nn_dense_skip_bias_in_signal);
+    src.relay_sim_relay_nn_dense_block_in(relay_sim_relay_nn_dense_block_in_signal);
+
+    // bind vector op signals from Source
+    src.relay_sim_relay_vector_func_opcode_in(relay_sim_relay_vector_func_opcode_in_signal);
+    src.relay_sim_relay_vector_func_size_in(relay_sim_relay_vector_func_size_in_signal);
+    src.relay_sim_relay_vector_func_op0_addr_in(relay_sim_relay_vector_func_op0_addr_in_signal);
+    src.relay_sim_relay_vector_func_op1_addr_in(relay_sim_relay_vector_func_op1_addr_in_signal);
+    src.relay_sim_relay_vector_func_output_addr_in(relay_sim_relay_vector_func_output_addr_in_signal);
+    src.relay_sim_relay_vector_func_op0_stride_in(relay_sim_relay_vector_func_op0_stride_in_signal);
+    src.relay_sim_relay_vector_func_op1_stride_in(relay_sim_relay_vector_func_op1_stride_in_signal);
+    src.relay_sim_relay_vector_func_output_stride_in(relay_sim_relay_vector_func_output_stride_in_signal);
+
+    // bind burst tensor store signals from Source
+    src.relay_sim_relay_data_in_wide_in(relay_sim_relay_data_in_wide_in_signal);
+    src.relay_sim_relay_burst_len_in_in(relay_sim_relay_burst_len_in_in_signal);
+    src.relay_sim_relay_data_out_mem_in_in(relay_sim_relay_data_out_mem_in_in_signal);
+
+    // bind maxpooling output placement signals from Source
+    src.relay_sim_maxpooling_out_base_in_in(relay_sim_maxpooling_out_base_in_in_signal);
+    src.relay_sim_maxpooling_out_row_stride_in_in(relay_sim_maxpooling_out_row_stride_in_in_signal);
+    src.relay_sim_maxpooling_out_plane_stride_in_in(relay_sim_maxpooling_out_plane_stride_in_in_signal);
+    src.relay_sim_maxpooling_in_plane_stride_in_in(relay_sim_maxpooling_in_plane_stride_in_in_signal);
 
 
     // binding the signals for the model
@@ -268,6 +741,7 @@ SC_MODULE(testbench) {
     relay.relay_sim_padding_in_x_in(relay_sim_padding_in_x_signal);
     relay.relay_sim_layout_in_in(relay_sim_layout_in_signal);
     relay.relay_sim_ceil_mode_in_in(relay_sim_ceil_mode_in_signal);
+    relay.relay_sim_maxpooling_mode_in_in(relay_sim_maxpooling_mode_in_signal);
 
 
     // bind lstm signals to relay_sim
@@ -285,14 +759,49 @@ SC_MODULE(testbench) {
     relay.relay_sim_relay_lstm_temp_vector0_addr_in(relay_sim_relay_lstm_temp_vector0_addr_in_signal);
     relay.relay_sim_relay_lstm_temp_vector1_addr_in(relay_sim_relay_lstm_temp_vector1_addr_in_signal);
     relay.relay_sim_relay_lstm_temp_vector2_addr_in(relay_sim_relay_lstm_temp_vector2_addr_in_signal);    
+    relay.relay_sim_relay_lstm_seq_len_in(relay_sim_relay_lstm_seq_len_in_signal);
+    relay.relay_sim_relay_lstm_input_stride_in(relay_sim_relay_lstm_input_stride_in_signal);
+    relay.relay_sim_relay_lstm_hidden_stride_in(relay_sim_relay_lstm_hidden_stride_in_signal);
+
+    // bind nn dense signals to relay_sim
+    relay.relay_sim_relay_nn_dense_in_size_in(relay_sim_relay_nn_dense_in_size_in_signal);
+    relay.relay_sim_relay_nn_dense_out_size_in(relay_sim_relay_nn_dense_out_size_in_signal);
+    relay.relay_sim_relay_nn_dense_batch_in(relay_sim_relay_nn_dense_batch_in_signal);
+    relay.relay_sim_relay_nn_dense_input_addr_in(relay_sim_relay_nn_dense_input_addr_in_signal);
+    relay.relay_sim_relay_nn_dense_weight_addr_in(relay_sim_relay_nn_dense_weight_addr_in_signal);
+    relay.relay_sim_relay_nn_dense_bias_addr_in(relay_sim_relay_nn_dense_bias_addr_in_signal);
+    relay.relay_sim_relay_nn_dense_output_addr_in(relay_sim_relay_nn_dense_output_addr_in_signal);
+    relay.relay_sim_relay_nn_dense_input_stride_in(relay_sim_relay_nn_dense_input_stride_in_signal);
+    relay.relay_sim_relay_nn_dense_output_stride_in(relay_sim_relay_nn_dense_output_stride_in_signal);
+    relay.relay_sim_relay_nn_dense_accumulate_in(relay_sim_relay_nn_dense_accumulate_in_signal);
+    relay.relay_sim_relay_nn_dense_skip_bias_in(relay_sim_relay_nn_dense_skip_bias_in_signal);
+    relay.relay_sim_relay_nn_dense_block_in(relay_sim_relay_nn_dense_block_in_signal);
+
+    // bind vector op signals to relay_sim
+    relay.relay_sim_relay_vector_func_opcode_in(relay_sim_relay_vector_func_opcode_in_signal);
+    relay.relay_sim_relay_vector_func_size_in(relay_sim_relay_vector_func_size_in_signal);
+    relay.relay_sim_relay_vector_func_op0_addr_in(relay_sim_relay_vector_func_op0_addr_in_signal);
+    relay.relay_sim_relay_vector_func_op1_addr_in(relay_sim_relay_vector_func_op1_addr_in_signal);
+    relay.relay_sim_relay_vector_func_output_addr_in(relay_sim_relay_vector_func_output_addr_in_signal);
+    relay.relay_sim_relay_vector_func_op0_stride_in(relay_sim_relay_vector_func_op0_stride_in_signal);
+    relay.relay_sim_relay_vector_func_op1_stride_in(relay_sim_relay_vector_func_op1_stride_in_signal);
+    relay.relay_sim_relay_vector_func_output_stride_in(relay_sim_relay_vector_func_output_stride_in_signal);
+
+    // bind burst tensor store signals to relay_sim
+    relay.relay_sim_relay_data_in_wide_in(relay_sim_relay_data_in_wide_in_signal);
+    relay.relay_sim_relay_burst_len_in_in(relay_sim_relay_burst_len_in_in_signal);
+    relay.relay_sim_relay_data_out_mem_in_in(relay_sim_relay_data_out_mem_in_in_signal);
+
+    // bind maxpooling output placement signals to relay_sim
+    relay.relay_sim_maxpooling_out_base_in_in(relay_sim_maxpooling_out_base_in_in_signal);
+    relay.relay_sim_maxpooling_out_row_stride_in_in(relay_sim_maxpooling_out_row_stride_in_in_signal);
+    relay.relay_sim_maxpooling_out_plane_stride_in_in(relay_sim_maxpooling_out_plane_stride_in_in_signal);
+    relay.relay_sim_maxpooling_in_plane_stride_in_in(relay_sim_maxpooling_in_plane_stride_in_in_signal);
 
     SC_THREAD(run);
   }
 
   void run() {
-    int i = 0;
-    bool done = false;
-
     std::ofstream fout;
     fout.open("relay_data_out.txt", ofstream::out | ofstream::trunc);
     // fout.basic_ios<char>::rdbuf(std::cout.rdbuf());
@@ -302,95 +811,110 @@ SC_MODULE(testbench) {
     wait(10, SC_NS);
     std::cout << "@" << sc_time_stamp() << " ********* simulation start *********" << std::endl;
 
+    int completed = 0;
+    for (size_t c = 0; c < sim_cases.size(); c++) {
+      completed += run_case(sim_cases[c], fout);
+    }
+    fout.close();
+    std::cout << "cases completed: " << completed << "/" << sim_cases.size()
+              << std::endl;
+    sc_stop();
+  }
+
+  // load one case into a freshly reset relay_memory, let the source run it
+  // and compare the next hidden state with the reference
+  bool run_case(const sim_case& c, std::ofstream& fout) {
+    if (!map_lstm_bin(c.path.c_str())) {
+      std::cout << "CASE " << c.name << " status=error" << std::endl;
+      return false;
+    }
+    std::cout<<"input size: "<<in_sz<<"\noutput size: "<<out_sz<<"\n";
+
+    // the memories are cleared here, the control states by the func_reset
+    // the source issues before the call
+    relay.relay_sim_relay_memory.clear();
+    relay.relay_sim_relay_tensor_mem.clear();
+    next_cell_out.clear();
+    next_hidden_out.clear();
+
     int word_cntr = 0;
     // order: input, cell, hidden, i2h_weight, h2h_weight, i2h_bias, h2h_bias
-    READ_WORDS(file, in_sz, relay.relay_sim_relay_memory, word_cntr);
-    READ_WORDS(file, out_sz, relay.relay_sim_relay_memory, word_cntr);
-    READ_WORDS(file, out_sz, relay.relay_sim_relay_memory, word_cntr);
-    READ_WORDS(file, 4 * out_sz * in_sz, relay.relay_sim_relay_memory, word_cntr);
-    READ_WORDS(file, 4 * out_sz * out_sz, relay.relay_sim_relay_memory, word_cntr);
-    READ_WORDS(file, 4 * out_sz, relay.relay_sim_relay_memory, word_cntr);
-    READ_WORDS(file, 4 * out_sz, relay.relay_sim_relay_memory, word_cntr);
+    for (int i = 0; i < LSTM_BIN_REFERENCE; i++) {
+      load_words(relay.relay_sim_relay_memory, lstm_sections[i], word_cntr);
+    }
 
     std::cout<<"word cntr is at : "<<dec<<word_cntr<<"\n";
 
-    wait(100, SC_NS);
-    // while(!done) {
-      if (relay.relay_sim_relay_lstm_state.to_int() == 12) {
-        done = true; // end state: 12 in relay_lstm.h
-      }
+    auto wall_start = std::chrono::steady_clock::now();
+    readback_done = false;
+    memory_loaded = true;
+    wait(readback_event);
+    double wall_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - wall_start)
+                         .count();
+
+    // results read back by the source, nothing to compare on a timeout
+    bool done = ((int)next_hidden_out.size() == out_sz);
+    double rel_err = done ? write_results(c, fout) : 0;
+    unmap_lstm_bin();
+
+    std::cout << "CASE " << c.name << " status=" << (done ? "ok" : "timeout")
+              << " in=" << in_sz << " out=" << out_sz
+              << " cycles=" << last_cycles << " instrs=" << last_instrs
+              << " wall_ms=" << std::fixed << std::setprecision(3) << wall_ms
+              << std::defaultfloat << " rel_err=" << std::setprecision(6)
+              << rel_err << std::endl;
+    return done;
+  }
 
-      //cout << "@" << sc_time_stamp() << '\t';
-      //cout << "is write: " << (relay.relay_sim_relay_func_id.to_int() == 2) << '\t';
-    // }
-      
-
-    if (done) {
-      // relay.instr_log.flush();
-      wait(100, SC_NS);
-      fout << "********* output for tensor memory ***********" << endl;
-      fout <<"<><><><><>next_cell_state:\n";
-      std::ofstream obin("relay_out.bin");
-      for (int i = 0; i < out_sz; i++){
-        unsigned int hex_value = relay.relay_sim_relay_memory[WORD_ADDR(next_cell_addr)+i].to_uint();
-        float float_value = *(float*)&hex_value;
-        fout<<"\t0x"<<hex<<hex_value<<dec<<"\t float: "<<std::setprecision(6)<<float_value<<"\n";
-        obin.write((char*)&hex_value ,4);
-      }
+  // dump the results of a case, returns the average relative error (%)
+  double write_results(const sim_case& c, std::ofstream& fout) {
+    fout << "********* case " << c.name << " ***********" << endl;
+    fout <<"<><><><><>next_cell_state:\n";
+    // the raw outputs of a single case go to relay_out.bin as before
+    std::ofstream obin;
+    if (sim_cases.size() == 1) {
+      obin.open("relay_out.bin");
+    }
+    for (int i = 0; i < out_sz; i++){
+      unsigned int hex_value = next_cell_out[i];
+      float float_value = *(float*)&hex_value;
+      fout<<"\t0x"<<hex<<hex_value<<dec<<"\t float: "<<std::setprecision(6)<<float_value<<"\n";
+      obin.write((char*)&hex_value ,4);
+    }
 
-      int *output_val = new int[out_sz];
-      int *benchmark = new int[out_sz];
-      file.read((char*)benchmark, out_sz * WORD_SIZE);
-
-      double rel_err_acc = 0;
-      fout <<"<><><><><>next_hidden_state:\n";
-      for (int i = 0; i < out_sz; i++){
-        output_val[i] = relay.relay_sim_relay_memory[WORD_ADDR(next_hidden_addr) + i].to_uint();
-        float float_value = ((float*)output_val)[i];
-        fout<<"???? 0x"<<hex<<std::setw(8)<<std::setfill('0')<<output_val[i]<<dec<<"\t"<<std::setprecision(6)<<float_value<<"\n";
-        float benchmark_value = ((float*)benchmark)[i];
-        fout<<"++++ 0x"<<hex<<std::setw(8)<<std::setfill('0')<<benchmark[i]<<dec<<"\t"<<std::setprecision(6)<<benchmark_value<<"\n\n";
-        if (benchmark_value != 0.0)
-          rel_err_acc += abs(((double)float_value - (double)benchmark_value)/(double)benchmark_value);
-      }
-      fout<<"Average relative error: "<< rel_err_acc*100.0/out_sz<<"\n";
-      fout<<"====== compact float32 output (F[15]...F[0] each row):\n";
-
-      for (int i = 0; i < 4; i++) {
-        for (int j = 15; j >=0; j--){
-            float fval = ((float*)output_val)[i*16+j];
-            fout<<std::setprecision(6)<<fval<<" ";
-        }
-        fout<<"\n";
+    int *output_val = new int[out_sz];
+    int *benchmark = new int[out_sz];
+    memcpy(benchmark, lstm_sections[LSTM_BIN_REFERENCE].data,
+           out_sz * WORD_SIZE);
+
+    double rel_err_acc = 0;
+    fout <<"<><><><><>next_hidden_state:\n";
+    for (int i = 0; i < out_sz; i++){
+      output_val[i] = next_hidden_out[i];
+      float float_value = ((float*)output_val)[i];
+      fout<<"???? 0x"<<hex<<std::setw(8)<<std::setfill('0')<<output_val[i]<<dec<<"\t"<<std::setprecision(6)<<float_value<<"\n";
+      float benchmark_value = ((float*)benchmark)[i];
+      fout<<"++++ 0x"<<hex<<std::setw(8)<<std::setfill('0')<<benchmark[i]<<dec<<"\t"<<std::setprecision(6)<<benchmark_value<<"\n\n";
+      if (benchmark_value != 0.0)
+        rel_err_acc += abs(((double)float_value - (double)benchmark_value)/(double)benchmark_value);
+    }
+    double rel_err = rel_err_acc*100.0/out_sz;
+    fout<<"Average relative error: "<< rel_err<<"\n";
+    fout<<"====== compact float32 output (F[15]...F[0] each row):\n";
+
+    for (int i = 0; i < 4 && i * 16 + 15 < out_sz; i++) {
+      for (int j = 15; j >=0; j--){
+          float fval = ((float*)output_val)[i*16+j];
+          fout<<std::setprecision(6)<<fval<<" ";
       }
-      fout.close();
-      obin.write((char*)output_val, 4 * out_sz);
-      obin.close();
-      delete[] output_val;
-      delete[] benchmark;
-      /*
-      int entry_addr;
-      int index;
-      int tensor_out_y = relay.relay_sim_maxpooling_data_out_height.to_int() / 16;
-      int tensor_out_x = relay.relay_sim_maxpooling_data_out_width.to_int() / 16;
-      int entry_max_16 = tensor_out_x * tensor_out_y;
-
-      for (int j = 0; j < entry_max_16; j++) {
-          entry_addr = 16*j;
-          fout << "tensor mem @ addr:" << '\t';
-          fout << hex << entry_addr << '\t';
-          fout << "data:" << '\t';
-          for (int k = 0; k < 16; k++) {
-              index = 16*j + 15 - k;
-              fout << hex << relay.decode_relay_sim_func_tensor_store_update_relay_sim_relay_tensor_mem_map[index] << ' ';
-          }
-          fout << endl;
-      }*/
-
-      wait(1000, SC_NS);
-      sc_stop();
+      fout<<"\n";
     }
-
+    obin.write((char*)output_val, 4 * out_sz);
+    obin.close();
+    delete[] output_val;
+    delete[] benchmark;
+    return rel_err;
   }
 };
 
@@ -398,17 +922,38 @@ SC_MODULE(testbench) {
 
 int sc_main(int argc, char *argv[]) {
   std::cout << "test started" << endl;
-  
-  char buf[4];
-  file = ifstream("lstm.bin", std::ifstream::binary);
-  file.read(buf, 4);
-  in_sz = *(int*)buf;
-  file.read(buf, 4);
-  out_sz = *(int*)buf;
-  std::cout<<"input size: "<<in_sz<<"\noutput size: "<<out_sz<<"\n";
+
+  const char* manifest = nullptr;
+  bool usage = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "c:m:")) != -1) {
+    switch (opt) {
+    case 'c':
+      run_max_cycles = std::atol(optarg);
+      break;
+    case 'm':
+      manifest = optarg;
+      break;
+    default:
+      usage = true;
+    }
+  }
+  if (usage || optind != argc || run_max_cycles < 0) {
+    std::cerr << "usage: " << argv[0]
+              << " [-c <max_cycles>] [-m <manifest>]\n";
+    return 1;
+  }
+
+  if (manifest) {
+    if (!read_manifest(manifest)) {
+      std::cerr << "no cases in " << manifest << "\n";
+      return 1;
+    }
+  } else {
+    sim_cases.push_back({"lstm.bin", "lstm.bin"});
+  }
 
   testbench tb("tb");
   sc_start();
   return 0;
 }
-
@@ -0,0 +1,384 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2020 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: sweep.cc
+//
+// Sweep driver for the generated simulator: hands the cases of a manifest
+// (the format of `relay_sim -m`) out to N worker slots from a queue, in
+// batches that shrink as the queue drains. Each batch runs in one
+// `relay_sim -m` process in its own directory as soon as a slot is free, and
+// the CASE lines and the timing of all batches are merged into one report.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// smallest batch handed out while the queue is long enough, so that the
+// startup of relay_sim (SystemC elaboration, sc_start) is shared by a few
+// cases
+#define SWEEP_MIN_BATCH 4
+// batches are sized to the remaining cases / (SWEEP_BATCH_SHARES * workers),
+// large ones first, small ones to even out the end of the sweep
+#define SWEEP_BATCH_SHARES 2
+
+struct Case {
+  std::string path;
+  std::string name;
+  int batch = -1;
+  std::string result; // CASE line
+};
+
+// cases of the manifest (indices) run by one relay_sim, in this order
+struct Batch {
+  std::vector<size_t> cases;
+  std::string dir;
+  int worker = -1;
+  pid_t pid = -1;
+  int status = 0;
+  Clock::time_point started;
+  double wall_s = 0;
+};
+
+struct Worker {
+  int batches = 0;
+  int cases = 0;
+  double busy_s = 0;
+};
+
+double Seconds(const Clock::time_point& start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string AbsPath(const std::string& path) {
+  char buf[PATH_MAX];
+  return realpath(path.c_str(), buf) ? std::string(buf) : path;
+}
+
+// relative case paths are taken from the directory of the manifest
+bool ReadCases(const std::string& manifest_path, std::vector<Case>& cases) {
+  std::ifstream manifest(manifest_path);
+  if (!manifest.is_open()) {
+    std::cerr << "cannot open " << manifest_path << "\n";
+    return false;
+  }
+  auto slash = manifest_path.rfind('/');
+  auto base = (slash == std::string::npos) ? std::string(".")
+                                           : manifest_path.substr(0, slash);
+
+  std::set<std::string> names;
+  std::string line;
+  while (std::getline(manifest, line)) {
+    std::istringstream fields(line.substr(0, line.find('#')));
+    Case c;
+    if (!(fields >> c.path)) {
+      continue;
+    }
+    if (!(fields >> c.name)) {
+      c.name = c.path;
+    }
+    // the report finds the CASE line of a case by its name
+    if (!names.insert(c.name).second) {
+      std::cerr << manifest_path << ": duplicate case name " << c.name << "\n";
+      return false;
+    }
+    if (c.path[0] != '/') {
+      c.path = AbsPath(base + "/" + c.path);
+    }
+    cases.push_back(c);
+  }
+  if (cases.empty()) {
+    std::cerr << "no cases in " << manifest_path << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool MakeDir(const std::string& dir) {
+  return mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+// run relay_sim -m cases.txt on the cases of a batch in the batch directory,
+// output to relay_sim.log
+pid_t Launch(const std::string& sim, const Batch& b,
+             const std::vector<Case>& cases) {
+  std::ofstream list(b.dir + "/cases.txt", std::ios::trunc);
+  for (auto i : b.cases) {
+    list << cases[i].path << " " << cases[i].name << "\n";
+  }
+  list.close();
+
+  auto pid = fork();
+  if (pid != 0) {
+    return pid;
+  }
+  if (chdir(b.dir.c_str()) != 0) {
+    _exit(127);
+  }
+  auto log = open("relay_sim.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (log < 0) {
+    _exit(127);
+  }
+  dup2(log, STDOUT_FILENO);
+  dup2(log, STDERR_FILENO);
+  close(log);
+  execl(sim.c_str(), sim.c_str(), "-m", "cases.txt", (char*)nullptr);
+  _exit(127);
+}
+
+// CASE lines of a batch log, by case name
+std::map<std::string, std::string> ReadResults(const Batch& b) {
+  std::map<std::string, std::string> results;
+  std::ifstream log(b.dir + "/relay_sim.log");
+  std::string line;
+  while (std::getline(log, line)) {
+    if (line.compare(0, 5, "CASE ") != 0) {
+      continue;
+    }
+    std::istringstream fields(line.substr(5));
+    std::string name;
+    fields >> name;
+    results[name] = line;
+  }
+  return results;
+}
+
+// fixed size if batch_size > 0, otherwise a share of the remaining cases
+size_t BatchSize(size_t remaining, int num_workers, int batch_size) {
+  size_t size = batch_size;
+  if (batch_size == 0) {
+    size = remaining / (SWEEP_BATCH_SHARES * num_workers);
+    size = std::max<size_t>(size, SWEEP_MIN_BATCH);
+  }
+  return std::min(size, remaining);
+}
+
+// value of key=... in a CASE line, empty if missing
+std::string Field(const std::string& line, const std::string& key) {
+  auto pos = line.find(" " + key + "=");
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos += key.size() + 2;
+  return line.substr(pos, line.find(' ', pos) - pos);
+}
+
+void Usage(const char* prog) {
+  std::cerr << "usage: " << prog
+            << " [-j workers] [-b batch] [-d work_dir] [-o report] <relay_sim>"
+               " <cases>\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  // one single-threaded relay_sim per core at a time
+  auto num_workers = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+  auto workers_set = false;
+  auto batch_size = 0;
+  std::string work_dir = "sweep";
+  std::string report_path;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "j:b:d:o:")) != -1) {
+    switch (opt) {
+    case 'j':
+      num_workers = std::atoi(optarg);
+      workers_set = true;
+      break;
+    case 'b':
+      batch_size = std::atoi(optarg);
+      break;
+    case 'd':
+      work_dir = optarg;
+      break;
+    case 'o':
+      report_path = optarg;
+      break;
+    default:
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  if (argc - optind != 2 || num_workers < 1 || batch_size < 0) {
+    Usage(argv[0]);
+    return 1;
+  }
+  auto sim = AbsPath(argv[optind]);
+
+  std::vector<Case> cases;
+  if (!ReadCases(argv[optind + 1], cases)) {
+    return 1;
+  }
+
+  // by default no more workers than there are minimum batches, so that a
+  // small sweep does not start a process per case; never more than cases
+  if (!workers_set) {
+    auto batches = (cases.size() + SWEEP_MIN_BATCH - 1) / SWEEP_MIN_BATCH;
+    num_workers = std::min<size_t>(num_workers, batches);
+  }
+  num_workers = std::min<size_t>(num_workers, cases.size());
+  std::vector<Worker> workers(num_workers);
+
+  if (!MakeDir(work_dir)) {
+    std::cerr << "cannot create " << work_dir << "\n";
+    return 1;
+  }
+
+  // the next batch of the queue goes to the first free worker slot, so a slow
+  // batch holds up only its own slot
+  auto start = Clock::now();
+  std::deque<size_t> queue;
+  for (size_t i = 0; i < cases.size(); i++) {
+    queue.push_back(i);
+  }
+  std::vector<Batch> batches;
+  std::vector<int> free_slots;
+  for (auto i = num_workers - 1; i >= 0; i--) {
+    free_slots.push_back(i);
+  }
+  std::map<pid_t, size_t> running;
+  while (!queue.empty() || !running.empty()) {
+    while (!queue.empty() && !free_slots.empty()) {
+      Batch b;
+      auto size = BatchSize(queue.size(), num_workers, batch_size);
+      for (size_t k = 0; k < size; k++) {
+        cases[queue.front()].batch = batches.size();
+        b.cases.push_back(queue.front());
+        queue.pop_front();
+      }
+      b.dir = work_dir + "/batch" + std::to_string(batches.size());
+      b.worker = free_slots.back();
+      b.started = Clock::now();
+      if (!MakeDir(b.dir) || (b.pid = Launch(sim, b, cases)) < 0) {
+        std::cerr << "cannot start batch " << batches.size() << "\n";
+        batches.push_back(b);
+        continue;
+      }
+      free_slots.pop_back();
+      running[b.pid] = batches.size();
+      batches.push_back(b);
+    }
+    if (running.empty()) {
+      continue;
+    }
+
+    int status;
+    auto pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      break;
+    }
+    auto it = running.find(pid);
+    if (it == running.end()) {
+      continue;
+    }
+    auto& b = batches[it->second];
+    b.status = status;
+    b.wall_s = Seconds(b.started);
+    auto& w = workers[b.worker];
+    w.batches++;
+    w.cases += b.cases.size();
+    w.busy_s += b.wall_s;
+    free_slots.push_back(b.worker);
+    running.erase(it);
+
+    // a run that died is blamed on its first case without a CASE line, the
+    // cases after that one go back to the queue
+    auto results = ReadResults(b);
+    auto lost = false;
+    for (auto i : b.cases) {
+      auto found = results.find(cases[i].name);
+      if (found != results.end()) {
+        cases[i].result = found->second;
+      } else if (lost) {
+        queue.push_back(i);
+      } else {
+        lost = true;
+      }
+    }
+  }
+  auto wall_s = Seconds(start);
+
+  // merged report, cases in manifest order
+  std::ostringstream report;
+  report << std::fixed << std::setprecision(3);
+  int ok = 0;
+  double case_wall_s = 0;
+  for (auto& c : cases) {
+    if (c.batch < 0) {
+      continue; // never handed out, the wait loop failed
+    }
+    auto& b = batches[c.batch];
+    if (c.result.empty()) {
+      // no CASE line, the run died (or never started) in the case
+      auto exited = (b.pid > 0) && WIFEXITED(b.status);
+      report << "CASE " << c.name << " status=lost worker=" << b.worker
+             << " batch=" << c.batch
+             << " exit=" << (exited ? WEXITSTATUS(b.status) : -1) << "\n";
+      continue;
+    }
+    report << c.result << " worker=" << b.worker << " batch=" << c.batch
+           << "\n";
+    ok += (Field(c.result, "status") == "ok");
+    case_wall_s += std::atof(Field(c.result, "wall_ms").c_str()) / 1000;
+  }
+
+  for (auto i = 0; i < num_workers; i++) {
+    report << "WORKER " << i << " batches=" << workers[i].batches
+           << " cases=" << workers[i].cases
+           << " busy_s=" << workers[i].busy_s << "\n";
+  }
+  // case_wall_s is the simulation time a single process would have needed
+  report << "SWEEP cases=" << cases.size() << " ok=" << ok
+         << " batches=" << batches.size() << " workers=" << num_workers
+         << " wall_s=" << wall_s << " case_wall_s=" << case_wall_s << "\n";
+
+  std::cout << report.str();
+  if (!report_path.empty()) {
+    std::ofstream fout(report_path, std::ios::trunc);
+    fout << report.str();
+  }
+
+  return ok == static_cast<int>(cases.size()) ? 0 : 1;
+}
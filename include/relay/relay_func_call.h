@@ -45,20 +45,24 @@ namespace relay {
 #define F_LSTM "func_lstm"
 #define F_LSTM_ID 3
 
-// #define F_VECTOR_ADD "func_vector_add"
-// #define F_VECTOR_ADD_ID 4
+// add/multiply/sigmoid/tanh are selected by the vector opcode argument
+#define F_VECTOR_OP "func_vector_op"
+#define F_VECTOR_OP_ID 4
 
-// #define F_VECTOR_MULTIPLY "func_vector_multiply"
-// #define F_VECTOR_MULTIPLY_ID 5
+#define F_NN_DENSE "func_nn_dense"
+#define F_NN_DENSE_ID 8
 
-// #define F_VECTOR_SIGMOID "func_vector_sigmoid"
-// #define F_VECTOR_SIGMOID_ID 6
+// store a 16-byte line of relay_data_in_wide at data_in_y
+#define F_TENSOR_STORE_BURST "func_tensor_store_burst"
+#define F_TENSOR_STORE_BURST_ID 9
 
-// #define F_VECTOR_TANH "func_vector_tanh"
-// #define F_VECTOR_TANH_ID 7
+// read a 16-byte line at data_in_y into relay_data_out
+#define F_DATA_OUT "func_data_out"
+#define F_DATA_OUT_ID 10
 
-// #define F_NN_DENSE "func_nn_dense"
-// #define F_NN_DENSE_ID 8
+// return the control states of all functions to idle
+#define F_RESET "func_reset"
+#define F_RESET_ID 11
 
 } // namespace relay
 
@@ -38,7 +38,7 @@ namespace relay {
 #define RELAY_WAIT_STATE 0
 #define RELAY_LSTM_DENSE_I2H_STATE 1
 #define RELAY_LSTM_DENSE_H2H_STATE 2
-#define RELAY_LSTM_ADD_DENSE_STATE 3
+// #define RELAY_LSTM_ADD_DENSE_STATE 3
 #define RELAY_LSTM_SIGMOID_STATE 4
 #define RELAY_LSTM_CELL_TANH_STATE 5
 #define RELAY_LSTM_OUTPUT_GATE_STATE 6
@@ -48,11 +48,20 @@ namespace relay {
 #define RELAY_LSTM_NEXT_CELL_TANH_STATE 10
 #define RELAY_LSTM_OUTPUT_STATE 11
 #define RELAY_LSTM_END_STATE 12
+#define RELAY_LSTM_FUSED_CELL_STATE 13
+#define RELAY_LSTM_NEXT_STEP_STATE 14
+
+// compute the gates, next cell and next hidden state in one instruction per
+// element instead of the vector-op passes (0 keeps the vector-op sequence)
+#define RELAY_LSTM_FUSED_CELL 1
+
+// rows per block of the I2H/H2H dense (the output size O*4 is a multiple of 4)
+#define RELAY_LSTM_DENSE_BLOCK 4
 
 #define RELAY_LSTM_MATRIX_VECTOR "relay_lstm_matrix_vector_module"
 #define RELAY_LSTM_DENSE_I2H_INSTR "relay_lstm_dense_i2h_instr"
 #define RELAY_LSTM_DENSE_H2H_INSTR "relay_lstm_dense_h2h_instr"
-#define RELAY_LSTM_ADD_DENSE_INSTR "relay_lstm_add_dense_instr"
+// #define RELAY_LSTM_ADD_DENSE_INSTR "relay_lstm_add_dense_instr"
 #define RELAY_LSTM_SIGMOID_INSTR "relay_lstm_sigmoid_instr"
 #define RELAY_LSTM_CELL_TANH_INSTR "relay_lstm_cell_tanh_instr"
 #define RELAY_LSTM_OUTPUT_GATE_INSTR "relay_lstm_output_gate_instr"
@@ -61,6 +70,8 @@ namespace relay {
 #define RELAY_LSTM_NEXT_CELL_INSTR "relay_lstm_next_cell_instr"
 #define RELAY_LSTM_NEXT_CELL_TANH_INSTR "relay_lstm_next_cell_tanh_instr"
 #define RELAY_LSTM_OUTPUT_INSTR "relay_lstm_output_instr"
+#define RELAY_LSTM_FUSED_CELL_INSTR "relay_lstm_fused_cell_instr"
+#define RELAY_LSTM_NEXT_STEP_INSTR "relay_lstm_next_step_instr"
 
 #define RELAY_LSTM_FLAG_BW 1
 #define RELAY_LSTM_FLAG_ON 1
@@ -87,10 +98,29 @@ namespace relay {
 #define RELAY_LSTM_TEMP_VECTOR1_ADDR "relay_lstm_temp_vector1_addr"
 #define RELAY_LSTM_TEMP_VECTOR2_ADDR "relay_lstm_temp_vector2_addr"
 
+// sequence of timesteps (0 is treated as 1), input of step t at
+// input_addr + t * input_stride. With hidden_stride 0 the hidden states
+// alternate between hidden/next_hidden, otherwise hidden state t is written to
+// next_hidden_addr + t * hidden_stride. Cell states always alternate between
+// cell/next_cell.
+#define RELAY_LSTM_SEQ_LEN "relay_lstm_seq_len"
+#define RELAY_LSTM_INPUT_STRIDE "relay_lstm_input_stride"
+#define RELAY_LSTM_HIDDEN_STRIDE "relay_lstm_hidden_stride"
+
 // states
 
 #define RELAY_LSTM_START "relay_lstm_start"
 #define RELAY_LSTM_STATE "relay_lstm_state"
+#define RELAY_LSTM_CELL_CNTR "relay_lstm_cell_cntr"
+
+// timestep counter and the buffers of the current timestep, after the last
+// step cell/hidden point to the final states
+#define RELAY_LSTM_STEP_CNTR "relay_lstm_step_cntr"
+#define RELAY_LSTM_STEP_INPUT_ADDR "relay_lstm_step_input_addr"
+#define RELAY_LSTM_STEP_CELL_ADDR "relay_lstm_step_cell_addr"
+#define RELAY_LSTM_STEP_NEXT_CELL_ADDR "relay_lstm_step_next_cell_addr"
+#define RELAY_LSTM_STEP_HIDDEN_ADDR "relay_lstm_step_hidden_addr"
+#define RELAY_LSTM_STEP_NEXT_HIDDEN_ADDR "relay_lstm_step_next_hidden_addr"
 
 } // namespace relay
 
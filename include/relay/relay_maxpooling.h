@@ -36,10 +36,10 @@ namespace relay {
 
 // define input data info (default input layout NCHW)
 #define DATA_IN_BATCH "data_in_batch"
-#define DATA_IN_BATCH_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+#define DATA_IN_BATCH_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
 
 #define DATA_IN_CHANNEL "data_in_channel"
-#define DATA_IN_CHANNEL_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+#define DATA_IN_CHANNEL_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
 
 #define DATA_IN_Y "data_in_y"
 #define DATA_IN_Y_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
@@ -76,6 +76,42 @@ namespace relay {
 #define CEIL_MODE_IN "ceil_mode_in"
 #define CEIL_MODE_IN_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
 
+// define input maxpooling mode
+#define MAXPOOLING_MODE_IN "maxpooling_mode_in"
+#define MAXPOOLING_MODE_IN_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+// value of the window elements in the padding (out of the input plane), the
+// most negative adpfloat8 so that it never wins the max
+#define MAXPOOLING_PAD_VALUE 0xFF
+
+// define inputs for the output placement, the pooled planes can be written
+// into the next layer's buffer or into a channel slot of a larger tensor
+// address of output (0, 0) of the first plane
+#define MAXPOOLING_OUT_BASE_IN "maxpooling_out_base_in"
+#define MAXPOOLING_OUT_BASE_IN_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// distance between output rows, 0 means width_out
+#define MAXPOOLING_OUT_ROW_STRIDE_IN "maxpooling_out_row_stride_in"
+#define MAXPOOLING_OUT_ROW_STRIDE_IN_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// distance between output planes, 0 means height_out * row stride
+#define MAXPOOLING_OUT_PLANE_STRIDE_IN "maxpooling_out_plane_stride_in"
+#define MAXPOOLING_OUT_PLANE_STRIDE_IN_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// distance between input planes, 0 means data_in_y * data_in_x
+#define MAXPOOLING_IN_PLANE_STRIDE_IN "maxpooling_in_plane_stride_in"
+#define MAXPOOLING_IN_PLANE_STRIDE_IN_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// read every window element from the tensor memory
+#define MAXPOOLING_MODE_DIRECT 0
+// max over window rows first (kept in a row buffer), then over the columns
+#define MAXPOOLING_MODE_SEPARABLE 1
+// MAXPOOLING_LANES adjacent output columns per step, like the FlexNLP 16-byte
+// vector datapath
+#define MAXPOOLING_MODE_LANES 2
+
+#define MAXPOOLING_LANES 16
+
 /************ internal states for maxpooling ***************/
 #define FLAG_BITWIDTH 1
 #define FLAG_DONE 1
@@ -102,7 +138,7 @@ namespace relay {
 // #define MAXPOOLING_VAR_UPDATE_FLAG_BITWIDTH FLAG_BITWIDTH
 
 #define MAXPOOLING_STATE "maxpooling_state"
-#define MAXPOOLING_STATE_BITWIDTH 3
+#define MAXPOOLING_STATE_BITWIDTH 4
 
 #define MAXPOOLING_STATE_INC_X 0
 #define MAXPOOLING_STATE_INC_Y 1
@@ -111,6 +147,11 @@ namespace relay {
 #define MAXPOOLING_STATE_WRITE 4
 #define MAXPOOLING_STATE_VAR_UPDATE 5
 #define MAXPOOLING_STATE_DONE 6
+#define MAXPOOLING_STATE_SEP_ROW 7
+#define MAXPOOLING_STATE_SEP_COL 8
+#define MAXPOOLING_STATE_NEXT_PLANE 9
+#define MAXPOOLING_STATE_LANE_MAX 10
+#define MAXPOOLING_STATE_LANE_WRITE 11
 
 // counter
 #define MAXPOOLING_X_LOOP_CNTR "maxpooling_X_loop_cntr"
@@ -125,17 +166,149 @@ namespace relay {
 #define MAXPOOLING_DATA_OUT_WIDTH "maxpooling_data_out_width"
 #define MAXPOOLING_DATA_OUT_WIDTH_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
 
-// child states for find max
-// find_max_cntr bitwidth should be twice larger than arg width
-#define MAXPOOLING_FIND_MAX_CNTR "maxpooling_find_max_cntr"
-#define MAXPOOLING_FIND_MAX_CNTR_BITWIDTH 2 * RELAY_FUNC_ARG_IN_BITWIDTH
+// function arguments latched at the call, the inputs may change while the
+// (multi-plane) call is running
+#define MAXPOOLING_DATA_IN_HEIGHT "maxpooling_data_in_height"
+#define MAXPOOLING_DATA_IN_HEIGHT_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_DATA_IN_WIDTH "maxpooling_data_in_width"
+#define MAXPOOLING_DATA_IN_WIDTH_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_POOL_Y "maxpooling_pool_y"
+#define MAXPOOLING_POOL_Y_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+#define MAXPOOLING_POOL_X "maxpooling_pool_x"
+#define MAXPOOLING_POOL_X_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+#define MAXPOOLING_STRIDE_Y "maxpooling_stride_y"
+#define MAXPOOLING_STRIDE_Y_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+#define MAXPOOLING_STRIDE_X "maxpooling_stride_x"
+#define MAXPOOLING_STRIDE_X_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+#define MAXPOOLING_PAD_Y "maxpooling_pad_y"
+#define MAXPOOLING_PAD_Y_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+#define MAXPOOLING_PAD_X "maxpooling_pad_x"
+#define MAXPOOLING_PAD_X_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+#define MAXPOOLING_OUT_ROW_STRIDE "maxpooling_out_row_stride"
+#define MAXPOOLING_OUT_ROW_STRIDE_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_OUT_PLANE_STRIDE "maxpooling_out_plane_stride"
+#define MAXPOOLING_OUT_PLANE_STRIDE_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_IN_PLANE_STRIDE "maxpooling_in_plane_stride"
+#define MAXPOOLING_IN_PLANE_STRIDE_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_MODE "maxpooling_mode"
+#define MAXPOOLING_MODE_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+// NCHW plane loop: batch * channel planes, each pooled into its own output
+// plane. Input planes are height_in * width_in apart, output planes
+// maxpooling_out_plane_stride apart.
+#define MAXPOOLING_PLANE_NUM "maxpooling_plane_num"
+#define MAXPOOLING_PLANE_NUM_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_PLANE_CNTR "maxpooling_plane_cntr"
+#define MAXPOOLING_PLANE_CNTR_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_IN_PLANE_BASE "maxpooling_in_plane_base"
+#define MAXPOOLING_IN_PLANE_BASE_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
 
+#define MAXPOOLING_OUT_PLANE_BASE "maxpooling_out_plane_base"
+#define MAXPOOLING_OUT_PLANE_BASE_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// window address generation of all modes, updated by additions only.
+// Coordinates are in the input plane and wrap around to large unsigned values
+// inside the top/left padding.
+// origin of the current window (output (cntr_Y, cntr_X))
+#define MAXPOOLING_WIN_X "maxpooling_win_x"
+#define MAXPOOLING_WIN_X_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_WIN_Y "maxpooling_win_y"
+#define MAXPOOLING_WIN_Y_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// address of input (win_y, 0)
+#define MAXPOOLING_WIN_ROW_ADDR "maxpooling_win_row_addr"
+#define MAXPOOLING_WIN_ROW_ADDR_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// stride_y * width_in, latched at the call
+#define MAXPOOLING_IN_ROW_STEP "maxpooling_in_row_step"
+#define MAXPOOLING_IN_ROW_STEP_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// address of output (cntr_Y, 0)
+#define MAXPOOLING_OUT_ROW_ADDR "maxpooling_out_row_addr"
+#define MAXPOOLING_OUT_ROW_ADDR_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// current window element: offset in the window, coordinates and the address
+// of its input row
+#define MAXPOOLING_ELEM_DX "maxpooling_elem_dx"
+#define MAXPOOLING_ELEM_DX_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+#define MAXPOOLING_ELEM_DY "maxpooling_elem_dy"
+#define MAXPOOLING_ELEM_DY_BITWIDTH RELAY_FUNC_ARG_IN_BITWIDTH
+
+#define MAXPOOLING_ELEM_X "maxpooling_elem_x"
+#define MAXPOOLING_ELEM_X_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_ELEM_Y "maxpooling_elem_y"
+#define MAXPOOLING_ELEM_Y_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_ELEM_ROW_ADDR "maxpooling_elem_row_addr"
+#define MAXPOOLING_ELEM_ROW_ADDR_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// child states for find max
 #define MAXPOOLING_FIND_MAX_RESULT "maxpooling_find_max_result"
 #define MAXPOOLING_FIND_MAX_RESULT_BITWIDTH RELAY_FUNC_DATA_IN_BITWIDTH
 
 #define MAXPOOLING_FIND_MAX_CHILD_FLAG "maxpooling_find_max_child_flag"
 #define MAXPOOLING_FIND_MAX_CHILD_FLAG_BITWIDTH FLAG_BITWIDTH
 
+// states for the separable mode
+
+// child state: maxima of the pool_x wide row segments, ring buffer of pool_y
+// rows x width_out
+#define MAXPOOLING_ROW_BUF "maxpooling_row_buf"
+#define MAXPOOLING_ROW_BUF_ADDR_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+#define MAXPOOLING_ROW_BUF_DATA_BITWIDTH RELAY_FUNC_DATA_IN_BITWIDTH
+
+// next input row to be reduced into the row buffer
+#define MAXPOOLING_SEP_NEXT_ROW "maxpooling_sep_next_row"
+#define MAXPOOLING_SEP_NEXT_ROW_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// output column and offset inside the window of the current row/column pass
+#define MAXPOOLING_SEP_X "maxpooling_sep_x"
+#define MAXPOOLING_SEP_X_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_SEP_OFFSET "maxpooling_sep_offset"
+#define MAXPOOLING_SEP_OFFSET_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// row pass: input x of the segment of sep_x and address of input
+// (next_row - pad_y, 0)
+#define MAXPOOLING_SEP_IN_X "maxpooling_sep_in_x"
+#define MAXPOOLING_SEP_IN_X_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+#define MAXPOOLING_SEP_ROW_ADDR "maxpooling_sep_row_addr"
+#define MAXPOOLING_SEP_ROW_ADDR_BITWIDTH RELAY_FUNC_ADDR_IN_BITWIDTH
+
+// row buffer address of the ring slot the row pass writes next and of the
+// slot the column pass reads
+#define MAXPOOLING_SEP_RING_ADDR "maxpooling_sep_ring_addr"
+#define MAXPOOLING_SEP_RING_ADDR_BITWIDTH MAXPOOLING_ROW_BUF_ADDR_BITWIDTH
+
+#define MAXPOOLING_SEP_COL_ADDR "maxpooling_sep_col_addr"
+#define MAXPOOLING_SEP_COL_ADDR_BITWIDTH MAXPOOLING_ROW_BUF_ADDR_BITWIDTH
+
+// pool_y * width_out, latched at the call
+#define MAXPOOLING_SEP_RING_SIZE "maxpooling_sep_ring_size"
+#define MAXPOOLING_SEP_RING_SIZE_BITWIDTH MAXPOOLING_ROW_BUF_ADDR_BITWIDTH
+
+// child state: running maxima of the lanes, lane 0 in the lowest bits
+#define MAXPOOLING_LANE_RESULT "maxpooling_lane_result"
+#define MAXPOOLING_LANE_RESULT_BITWIDTH                                        \
+  (MAXPOOLING_LANES * RELAY_FUNC_DATA_IN_BITWIDTH)
+
 } // namespace relay
 
 } // namespace ilang
@@ -41,6 +41,29 @@ namespace relay {
 #define RELAY_NN_DENSE_LOOP_INIT_INSTR "relay_nn_dense_loop_init_instr"
 #define RELAY_NN_DENSE_LOOP_WRITE_INSTR "relay_nn_dense_loop_write_instr"
 #define RELAY_NN_DENSE_LOOP_FMA_INSTR "relay_nn_dense_loop_fma_instr"
+#define RELAY_NN_DENSE_LOOP_DOT_INSTR "relay_nn_dense_loop_dot_instr"
+// one batch instruction per group size n: RELAY_NN_DENSE_LOOP_BATCH_INSTR + n
+#define RELAY_NN_DENSE_LOOP_BATCH_INSTR "relay_nn_dense_loop_batch_instr_"
+#define RELAY_NN_DENSE_LOOP_NEXT_GROUP_INSTR                                   \
+  "relay_nn_dense_loop_next_group_instr"
+// one block dot/FMA instruction per block size n (2 to
+// RELAY_NN_DENSE_MAX_BLOCK): RELAY_NN_DENSE_LOOP_BLOCK_*_INSTR + n
+#define RELAY_NN_DENSE_LOOP_BLOCK_DOT_INSTR                                    \
+  "relay_nn_dense_loop_block_dot_instr_"
+#define RELAY_NN_DENSE_LOOP_BLOCK_FMA_INSTR                                    \
+  "relay_nn_dense_loop_block_fma_instr_"
+#define RELAY_NN_DENSE_LOOP_BLOCK_WRITE_INSTR                                  \
+  "relay_nn_dense_loop_block_write_instr"
+
+// number of multiply-accumulates folded into one dot-product step
+// (tiles that do not fit fall back to the scalar FMA instruction)
+#define RELAY_NN_DENSE_DOT_TILE 16
+
+// upper bound of the output rows computed together in the blocked mode
+// (one accumulator per row, every input load is shared by the block), and of
+// the batch columns computed together in the batched mode (one accumulator
+// per column, every weight load is shared by the group)
+#define RELAY_NN_DENSE_MAX_BLOCK 8
 
 #define RELAY_NN_DENSE_STATE "relay_nn_dense_state"
 #define RELAY_NN_DENSE_STATE_BW 8
@@ -57,6 +80,19 @@ namespace relay {
 #define RELAY_NN_OUTPUT_SIZE "relay_nn_output_size"
 #define RELAY_NN_INPUT_WRAP_AROUND "relay_nn_input_wrap_around"
 
+// batch_size columns, each input/output column is *_BATCH_STRIDE bytes apart
+#define RELAY_NN_BATCH_SIZE "relay_nn_batch_size"
+#define RELAY_NN_INPUT_BATCH_STRIDE "relay_nn_input_batch_stride"
+#define RELAY_NN_OUTPUT_BATCH_STRIDE "relay_nn_output_batch_stride"
+
+// add the result onto the existing output instead of overwriting it, and/or
+// leave out the bias (e.g. to chain K-split partial products)
+#define RELAY_NN_ACCUMULATE "relay_nn_accumulate"
+#define RELAY_NN_SKIP_BIAS "relay_nn_skip_bias"
+
+// rows per block, 0 or 1 runs the rows one by one (single column only)
+#define RELAY_NN_BLOCK_SIZE "relay_nn_block_size"
+
 #define RELAY_NN_WEIGHT_ADDR "relay_nn_weight_addr"
 #define RELAY_NN_BIAS_ADDR "relay_nn_bias_addr"
 #define RELAY_NN_INPUT_ADDR "relay_nn_input_addr"
@@ -64,11 +100,33 @@ namespace relay {
 
 #define RELAY_NN_DENSE_LOOP_CNTR "relay_nn_dense_loop_cntr"
 #define RELAY_NN_DENSE_LOOP_START "relay_nn_dense_loop_start"
+// first batch column of the current group
+#define RELAY_NN_DENSE_BATCH_INDEX "relay_nn_dense_batch_index"
 
 // internal child states
 #define RELAY_NN_DENSE_INPUT_INDEX "relay_nn_dense_input_index"
 #define RELAY_NN_DENSE_LOOP_FMA_CNTR "relay_nn_dense_loop_fma_cntr"
 #define RELAY_NN_DENSE_ACC "relay_nn_dense_acc"
+#define RELAY_NN_DENSE_BLOCK_ROWS "relay_nn_dense_block_rows"
+#define RELAY_NN_DENSE_BLOCK_CNTR "relay_nn_dense_block_cntr"
+// accumulator of block row r (r > 0) is RELAY_NN_DENSE_BLOCK_ACC + r,
+// row 0 uses RELAY_NN_DENSE_ACC
+#define RELAY_NN_DENSE_BLOCK_ACC "relay_nn_dense_block_acc_"
+
+// inputs of the nn dense function call
+
+#define RELAY_NN_DENSE_IN_SIZE "relay_nn_dense_in_size"
+#define RELAY_NN_DENSE_OUT_SIZE "relay_nn_dense_out_size"
+#define RELAY_NN_DENSE_BATCH "relay_nn_dense_batch"
+#define RELAY_NN_DENSE_INPUT_ADDR "relay_nn_dense_input_addr"
+#define RELAY_NN_DENSE_WEIGHT_ADDR "relay_nn_dense_weight_addr"
+#define RELAY_NN_DENSE_BIAS_ADDR "relay_nn_dense_bias_addr"
+#define RELAY_NN_DENSE_OUTPUT_ADDR "relay_nn_dense_output_addr"
+#define RELAY_NN_DENSE_INPUT_STRIDE "relay_nn_dense_input_stride"
+#define RELAY_NN_DENSE_OUTPUT_STRIDE "relay_nn_dense_output_stride"
+#define RELAY_NN_DENSE_ACCUMULATE "relay_nn_dense_accumulate"
+#define RELAY_NN_DENSE_SKIP_BIAS "relay_nn_dense_skip_bias"
+#define RELAY_NN_DENSE_BLOCK "relay_nn_dense_block"
 
 } // namespace relay
 
@@ -53,16 +53,17 @@ void DefineInternalState(Ila& m);
 
 // define Relay instructions
 void DefineTensorStore(Ila& m);
+void DefineTensorStoreBurst(Ila& m);
+void DefineDataOut(Ila& m);
+void DefineReset(Ila& m);
 void DefineMaxpooling2D(Ila& m);
 
 // define Relay operations
 
-void DefineVectorAdd(Ila& m);
-void DefineVectorMultiply(Ila& m);
-void DefineVectorSigmoid(Ila& m);
-void DefineVectorTanh(Ila& m);
+void DefineVectorOp(Ila& m);
 
 void DefineNNDense(Ila& m);
+void DefineNNDenseFunc(Ila& m);
 
 // define LSTM instructions
 void DefineLSTM(Ila& m);
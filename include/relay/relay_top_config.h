@@ -47,6 +47,16 @@ namespace relay {
 #define RELAY_DATA_IN "relay_data_in"
 #define RELAY_DATA_IN_BITWIDTH 8
 
+// define relay top level wide data in for burst stores, one 16-byte line
+// (byte 0 in the lowest bits) per function call
+#define RELAY_DATA_IN_WIDE "relay_data_in_wide"
+#define RELAY_DATA_IN_WIDE_BITWIDTH 128
+#define RELAY_DATA_IN_WIDE_BYTES 16
+
+// number of valid bytes in a burst (1 - 16), 0 means the full line
+#define RELAY_BURST_LEN_IN "relay_burst_len_in"
+#define RELAY_BURST_LEN_IN_BITWIDTH 8
+
 // define the function call ID to represent the functions in Relay/TVM
 #define RELAY_FUNC_ID_IN "relay_func_id"
 #define RELAY_FUNC_ID_IN_BITWIDTH 8
@@ -54,6 +64,24 @@ namespace relay {
 // define the tensor memory here
 #define RELAY_TENSOR_MEM "relay_tensor_mem"
 
+// define the data out register, one 16-byte line read by func_data_out
+#define RELAY_DATA_OUT "relay_data_out"
+#define RELAY_DATA_OUT_BITWIDTH 128
+#define RELAY_DATA_OUT_BYTES 16
+
+// memory read by func_data_out: relay_tensor_mem or relay_memory
+#define RELAY_DATA_OUT_MEM_IN "relay_data_out_mem_in"
+#define RELAY_DATA_OUT_MEM_IN_BITWIDTH 8
+#define RELAY_DATA_OUT_TENSOR_MEM 0
+#define RELAY_DATA_OUT_MEM 1
+
+// completion flag of the last function call, cleared by every call and set
+// once the function has finished (at once for tensor store and data out)
+#define RELAY_FUNC_DONE "relay_func_done"
+#define RELAY_FUNC_DONE_BITWIDTH 1
+#define RELAY_FUNC_DONE_OFF 0
+#define RELAY_FUNC_DONE_ON 1
+
 } // namespace relay
 
 } // namespace ilang
@@ -65,54 +65,51 @@ namespace relay {
 #define RELAY_VECTOR_OP1_ADDR "relay_vector_op1_addr"
 #define RELAY_VECTOR_OUTPUT_ADDR "relay_vector_output_addr"
 
-// vector add
-#define RELAY_VECTOR_ADD "relay_vector_add_instr"
-#define RELAY_VECTOR_ADD_ENABLE "relay_vector_add_enable"
+// byte distance between consecutive elements, RELAY_VECTOR_DATA_BYTES is a
+// dense vector and 0 broadcasts a single element (scalar operand)
+#define RELAY_VECTOR_OP0_STRIDE "relay_vector_op0_stride"
+#define RELAY_VECTOR_OP1_STRIDE "relay_vector_op1_stride"
+#define RELAY_VECTOR_OUTPUT_STRIDE "relay_vector_output_stride"
 
-#define RELAY_VECTOR_ADD_START "relay_vector_add_start"
+// vector-op engine: one child runs the op selected by the opcode, all ops
+// share the counter and the operand/output address states above
+#define RELAY_VECTOR_OP_INSTR "relay_vector_op_instr"
+#define RELAY_VECTOR_OP_ENABLE "relay_vector_op_enable"
+#define RELAY_VECTOR_OP_START "relay_vector_op_start"
 
-#define RELAY_VECTOR_ADD_CHILD "relay_vector_add_child_module"
-#define RELAY_VECTOR_ADD_CHILD_INSTR "relay_vector_add_child_instr"
-
-#define RELAY_VECTOR_ADD_OP0_ADDR RELAY_VECTOR_OP0_ADDR
-#define RELAY_VECTOR_ADD_OP1_ADDR RELAY_VECTOR_OP1_ADDR
-#define RELAY_VECTOR_ADD_OUTPUT_ADDR RELAY_VECTOR_OUTPUT_ADDR
+#define RELAY_VECTOR_OP_LOOP_CHILD "relay_vector_op_loop_child_module"
 
-// vector multiply
-#define RELAY_VECTOR_MULTIPLY "relay_vector_multiply_instr"
-#define RELAY_VECTOR_MULTIPLY_ENABLE "relay_vector_multiply_enable"
+#define RELAY_VECTOR_OPCODE "relay_vector_opcode"
+#define RELAY_VECTOR_OPCODE_BW 8
 
-#define RELAY_VECTOR_MULTIPLY_START "relay_vector_multiply_start"
+// op table entries, see DefineVectorOp
+#define RELAY_VECTOR_OPCODE_ADD 0
+#define RELAY_VECTOR_OPCODE_MULTIPLY 1
+#define RELAY_VECTOR_OPCODE_SIGMOID 2
+#define RELAY_VECTOR_OPCODE_TANH 3
 
-#define RELAY_VECTOR_MULTIPLY_CHILD "relay_vector_multiply_child_module"
+#define RELAY_VECTOR_ADD_CHILD_INSTR "relay_vector_add_child_instr"
 #define RELAY_VECTOR_MULTIPLY_CHILD_INSTR "relay_vector_multiply_child_instr"
-
-#define RELAY_VECTOR_MULTIPLY_OP0_ADDR RELAY_VECTOR_OP0_ADDR
-#define RELAY_VECTOR_MULTIPLY_OP1_ADDR RELAY_VECTOR_OP1_ADDR
-#define RELAY_VECTOR_MULTIPLY_OUTPUT_ADDR RELAY_VECTOR_OUTPUT_ADDR
-
-// vector sigmoid
-#define RELAY_VECTOR_SIGMOID "relay_vector_sigmoid_instr"
-#define RELAY_VECTOR_SIGMOID_ENABLE "relay_vector_sigmoid_enable"
-#define RELAY_VECTOR_SIGMOID_START "relay_vector_sigmoid_start"
-
-#define RELAY_VECTOR_SIGMOID_CHILD "relay_vector_sigmoid_child_module"
 #define RELAY_VECTOR_SIGMOID_CHILD_INSTR "relay_vector_sigmoid_child_instr"
-
-#define RELAY_VECTOR_SIGMOID_OP0_ADDR RELAY_VECTOR_OP0_ADDR
-#define RELAY_VECTOR_SIGMOID_OUTPUT_ADDR RELAY_VECTOR_OUTPUT_ADDR
-
-// vector tanh
-
-#define RELAY_VECTOR_TANH "relay_vector_tanh_instr"
-#define RELAY_VECTOR_TANH_ENABLE "relay_vector_tanh_enable"
-#define RELAY_VECTOR_TANH_START "relay_vector_tanh_start"
-
-#define RELAY_VECTOR_TANH_CHILD "relay_vector_tanh_child_module"
 #define RELAY_VECTOR_TANH_CHILD_INSTR "relay_vector_tanh_child_instr"
 
-#define RELAY_VECTOR_TANH_OP0_ADDR RELAY_VECTOR_OP0_ADDR
-#define RELAY_VECTOR_TANH_OUTPUT_ADDR RELAY_VECTOR_OUTPUT_ADDR
+// whole tiles of RELAY_VECTOR_OP_TILE elements go through one tile UF, the
+// scalar instructions above only run the tail
+#define RELAY_VECTOR_OP_TILE 16
+#define RELAY_VECTOR_ADD_TILE_INSTR "relay_vector_add_tile_instr"
+#define RELAY_VECTOR_MULTIPLY_TILE_INSTR "relay_vector_multiply_tile_instr"
+#define RELAY_VECTOR_SIGMOID_TILE_INSTR "relay_vector_sigmoid_tile_instr"
+#define RELAY_VECTOR_TANH_TILE_INSTR "relay_vector_tanh_tile_instr"
+
+// inputs of the vector op function call
+#define RELAY_VECTOR_FUNC_OPCODE "relay_vector_func_opcode"
+#define RELAY_VECTOR_FUNC_SIZE "relay_vector_func_size"
+#define RELAY_VECTOR_FUNC_OP0_ADDR "relay_vector_func_op0_addr"
+#define RELAY_VECTOR_FUNC_OP1_ADDR "relay_vector_func_op1_addr"
+#define RELAY_VECTOR_FUNC_OUTPUT_ADDR "relay_vector_func_output_addr"
+#define RELAY_VECTOR_FUNC_OP0_STRIDE "relay_vector_func_op0_stride"
+#define RELAY_VECTOR_FUNC_OP1_STRIDE "relay_vector_func_op1_stride"
+#define RELAY_VECTOR_FUNC_OUTPUT_STRIDE "relay_vector_func_output_stride"
 
 static auto bv_sort_out = SortRef::BV(RELAY_VECTOR_DATA_BW);
 static auto bv_sort_in0 = SortRef::BV(RELAY_VECTOR_DATA_BW);
@@ -123,6 +120,30 @@ static FuncRef bv_multiply("bv_multiply", bv_sort_out, bv_sort_in0,
                            bv_sort_in1);
 static FuncRef bv_add("bv_add", bv_sort_out, bv_sort_in0, bv_sort_in1);
 
+// fused multiply-add with a single rounding: bv_fma({a, b, c}) = a * b + c
+static auto bv_sort_in2 = SortRef::BV(RELAY_VECTOR_DATA_BW);
+static FuncRef bv_fma("bv_fma", bv_sort_out,
+                      {bv_sort_in0, bv_sort_in1, bv_sort_in2});
+
+// dot product of two tiles of RELAY_NN_DENSE_DOT_TILE packed words
+static auto bv_sort_dot_tile =
+    SortRef::BV(RELAY_VECTOR_DATA_BW * RELAY_NN_DENSE_DOT_TILE);
+static FuncRef bv_dot_product("bv_dot_product", bv_sort_out, bv_sort_dot_tile,
+                              bv_sort_dot_tile);
+
+// element-wise ops over RELAY_VECTOR_OP_TILE packed words, element k in bits
+// [32k+31:32k] of operands and result
+static auto bv_sort_vector_tile =
+    SortRef::BV(RELAY_VECTOR_DATA_BW * RELAY_VECTOR_OP_TILE);
+static FuncRef bv_add_tile("bv_add_tile", bv_sort_vector_tile,
+                           bv_sort_vector_tile, bv_sort_vector_tile);
+static FuncRef bv_multiply_tile("bv_multiply_tile", bv_sort_vector_tile,
+                                bv_sort_vector_tile, bv_sort_vector_tile);
+static FuncRef bv_sigmoid_tile("bv_sigmoid_tile", bv_sort_vector_tile,
+                               bv_sort_vector_tile);
+static FuncRef bv_tanh_tile("bv_tanh_tile", bv_sort_vector_tile,
+                            bv_sort_vector_tile);
+
 } // namespace relay
 
 } // namespace ilang
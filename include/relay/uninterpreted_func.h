@@ -40,6 +40,12 @@ namespace relay {
 static FuncRef signed_gt("signed_gt", UF_ARG, UF_ARG, UF_ARG);
 static FuncRef adpfloat_max("relay_adpfloat_max", UF_ARG, UF_ARG, UF_ARG);
 
+// lane-wise adpfloat_max of MAXPOOLING_LANES packed values
+#define UF_LANE_ARG SortRef::BV(MAXPOOLING_LANE_RESULT_BITWIDTH)
+
+static FuncRef adpfloat_max_16("relay_adpfloat_max_16", UF_LANE_ARG,
+                               UF_LANE_ARG, UF_LANE_ARG);
+
 } // namespace relay
 
 } // namespace ilang
@@ -6,6 +6,27 @@ from tvm.relay.testing.lstm import lstm_cell, get_workload
 import numpy as np
 import sys
 
+# sectioned lstm.bin header, see map_lstm_bin in app/sim_main.cc
+LSTM_BIN_MAGIC = 0x59414c52 # "RLAY"
+LSTM_BIN_VERSION = 1
+# section ids, in the order the sections are placed in relay_memory
+(LSTM_BIN_INPUT, LSTM_BIN_CELL, LSTM_BIN_HIDDEN, LSTM_BIN_I2H_WEIGHT,
+ LSTM_BIN_H2H_WEIGHT, LSTM_BIN_I2H_BIAS, LSTM_BIN_H2H_BIAS,
+ LSTM_BIN_REFERENCE) = range(8)
+
+def write_lstm_bin(f, in_sz, out_sz, sections):
+    # sections: list of (id, float32 ndarray), written back to back after
+    # the header; every field of the header is a little-endian uint32
+    header_words = 5 + 3 * len(sections)
+    offset = 4 * header_words
+    header = [LSTM_BIN_MAGIC, LSTM_BIN_VERSION, in_sz, out_sz, len(sections)]
+    for sec_id, arr in sections:
+        header += [sec_id, offset, arr.size]
+        offset += 4 * arr.size
+    np.array(header, dtype='<u4').tofile(f)
+    for _, arr in sections:
+        arr.astype('<f4').tofile(f)
+
 def generate_random_tensor(ty):
     return tvm.nd.array(np.random.uniform(-1.0, 1.0, tuple([int(i) for i in ty.shape])).astype(ty.dtype))
 
@@ -52,20 +73,7 @@ def main(argv):
     h2h_b_val = generate_random_tensor(bias_type)
 
 
-    # order: i_sz, o_sz,  input, cell, hidden, i2h_weight, h2h_weight, i2h_bias, h2h_bias
     f = open(argv[2], 'wb')
-    f.write(num_hidden.to_bytes(4, 'little'))
-    f.write(num_hidden.to_bytes(4, 'little'))
-
-
-    i_val.asnumpy().tofile(f)
-    cell_val.tofile(f)
-    hidden_val.tofile(f)
-    i2h_w_val.asnumpy().tofile(f)
-    h2h_w_val.asnumpy().tofile(f)
-    i2h_b_val.asnumpy().tofile(f)
-    h2h_b_val.asnumpy().tofile(f)
-    print("Wrote %d bytes" % f.tell())
 
     print("inputs:", i_val)
     print("cell:", cell_val)
@@ -99,7 +107,18 @@ def main(argv):
     out = ex.evaluate()(i_val, i2h_w_val, i2h_b_val, h2h_w_val, h2h_b_val)
 
     print("output: ", out)
-    out.asnumpy().tofile(f)
+    # the reference output is needed for the header, so the file is written
+    # in one go after the evaluation
+    write_lstm_bin(f, num_hidden, num_hidden, [
+        (LSTM_BIN_INPUT, i_val.asnumpy()),
+        (LSTM_BIN_CELL, cell_val),
+        (LSTM_BIN_HIDDEN, hidden_val),
+        (LSTM_BIN_I2H_WEIGHT, i2h_w_val.asnumpy()),
+        (LSTM_BIN_H2H_WEIGHT, h2h_w_val.asnumpy()),
+        (LSTM_BIN_I2H_BIAS, i2h_b_val.asnumpy()),
+        (LSTM_BIN_H2H_BIAS, h2h_b_val.asnumpy()),
+        (LSTM_BIN_REFERENCE, out.asnumpy()),
+    ])
 
     print("Wrote %d bytes" % f.tell())
     f.close()
@@ -39,6 +39,12 @@ void DefineArchState(Ila& m) {
 
   // memory space used by lstm/vector_op/nn_dense
   m.NewMemState(RELAY_MEMORY, RELAY_LSTM_ADDR_BW, RELAY_VECTOR_DATA_BW);
+
+  // data out register, read back by the host
+  m.NewBvState(RELAY_DATA_OUT, RELAY_DATA_OUT_BITWIDTH);
+
+  // completion flag, polled by the host
+  m.NewBvState(RELAY_FUNC_DONE, RELAY_FUNC_DONE_BITWIDTH);
 }
 
 } // namespace relay
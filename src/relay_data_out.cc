@@ -0,0 +1,96 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2020 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+
+// File: relay_data_out.cc
+
+// read a 16-byte line of relay_tensor_mem or relay_memory into the
+// architectural relay_data_out register, so that the results can be drained
+// by the host without looking into the simulator internals
+
+#include <vector>
+
+#include <ilang/util/log.h>
+
+#include <relay/relay_top.h>
+
+namespace ilang {
+
+namespace relay {
+
+void DefineDataOut(Ila& m) {
+  auto instr = m.NewInstr(F_DATA_OUT);
+
+  auto func_run = (m.input(RELAY_FUNC_RUN_IN) == RELAY_FUNC_RUN_ON);
+  auto func_id_match = (m.input(RELAY_FUNC_ID_IN) == F_DATA_OUT_ID);
+
+  instr.SetDecode(func_run & func_id_match);
+
+  auto tensor = m.state(RELAY_TENSOR_MEM);
+  auto memory = m.state(RELAY_MEMORY);
+  auto data_out = m.state(RELAY_DATA_OUT);
+
+  auto addr = m.input(DATA_IN_Y);
+  auto len = m.input(RELAY_BURST_LEN_IN);
+  auto from_memory = (m.input(RELAY_DATA_OUT_MEM_IN) == RELAY_DATA_OUT_MEM);
+
+  // bytes at and after len read as 0, on both memories
+  auto len_full = (len == 0) | !(len < RELAY_DATA_OUT_BYTES);
+  auto zero_byte = BvConst(0, RELAY_FUNC_DATA_IN_BITWIDTH);
+  auto byte_valid = [&](int i) {
+    return len_full | (BvConst(i, RELAY_BURST_LEN_IN_BITWIDTH) < len);
+  };
+
+  // relay_tensor_mem, one byte per address, byte 0 in the lowest bits
+  auto tensor_line = Ite(byte_valid(0), Load(tensor, addr), zero_byte);
+  for (auto i = 1; i < RELAY_DATA_OUT_BYTES; i++) {
+    auto byte = Ite(byte_valid(i), Load(tensor, addr + i), zero_byte);
+    tensor_line = Concat(byte, tensor_line);
+  }
+
+  // relay_memory, 4-byte words from byte address addr, masked per byte so a
+  // len inside the last word cuts that word too
+  auto words = RELAY_DATA_OUT_BYTES / RELAY_VECTOR_DATA_BYTES;
+  std::vector<ExprRef> memory_bytes;
+  for (auto i = 0; i < words; i++) {
+    auto word = RELAY_LOAD_WORD(memory, addr + i * RELAY_VECTOR_DATA_BYTES);
+    for (auto j = 0; j < RELAY_VECTOR_DATA_BYTES; j++) {
+      auto byte = Extract(word, 8 * j + 7, 8 * j);
+      auto index = i * RELAY_VECTOR_DATA_BYTES + j;
+      memory_bytes.push_back(Ite(byte_valid(index), byte, zero_byte));
+    }
+  }
+  auto memory_line = memory_bytes[0];
+  for (auto i = 1; i < RELAY_DATA_OUT_BYTES; i++) {
+    memory_line = Concat(memory_bytes[i], memory_line);
+  }
+
+  instr.SetUpdate(data_out, Ite(from_memory, memory_line, tensor_line));
+  instr.SetUpdate(m.state(RELAY_FUNC_DONE),
+                  BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH));
+}
+
+} // namespace relay
+
+} // namespace ilang
@@ -54,6 +54,17 @@ void DefineFuncInput(Ila& m) {
   m.NewBvInput(LAYOUT_IN, LAYOUT_IN_BITWIDTH);
   // input of ceiling mode
   m.NewBvInput(CEIL_MODE_IN, CEIL_MODE_IN_BITWIDTH);
+  // input of maxpooling mode
+  m.NewBvInput(MAXPOOLING_MODE_IN, MAXPOOLING_MODE_IN_BITWIDTH);
+  // input of output base address and strides
+  m.NewBvInput(MAXPOOLING_OUT_BASE_IN, MAXPOOLING_OUT_BASE_IN_BITWIDTH);
+  m.NewBvInput(MAXPOOLING_OUT_ROW_STRIDE_IN,
+               MAXPOOLING_OUT_ROW_STRIDE_IN_BITWIDTH);
+  m.NewBvInput(MAXPOOLING_OUT_PLANE_STRIDE_IN,
+               MAXPOOLING_OUT_PLANE_STRIDE_IN_BITWIDTH);
+  // input of the input plane stride
+  m.NewBvInput(MAXPOOLING_IN_PLANE_STRIDE_IN,
+               MAXPOOLING_IN_PLANE_STRIDE_IN_BITWIDTH);
 
   /**** Relay LSTM input ****/
   m.NewBvInput(RELAY_LSTM_IN_SIZE, RELAY_VECTOR_SIZE_BW);
@@ -74,6 +85,39 @@ void DefineFuncInput(Ila& m) {
   m.NewBvInput(RELAY_LSTM_TEMP_VECTOR0_ADDR, RELAY_LSTM_ADDR_BW);
   m.NewBvInput(RELAY_LSTM_TEMP_VECTOR1_ADDR, RELAY_LSTM_ADDR_BW);
   m.NewBvInput(RELAY_LSTM_TEMP_VECTOR2_ADDR, RELAY_LSTM_ADDR_BW);
+
+  m.NewBvInput(RELAY_LSTM_SEQ_LEN, RELAY_VECTOR_SIZE_BW);
+  m.NewBvInput(RELAY_LSTM_INPUT_STRIDE, RELAY_LSTM_ADDR_BW);
+  m.NewBvInput(RELAY_LSTM_HIDDEN_STRIDE, RELAY_LSTM_ADDR_BW);
+
+  /**** Relay nn dense input ****/
+  m.NewBvInput(RELAY_NN_DENSE_IN_SIZE, RELAY_NN_SIZE_BW);
+  m.NewBvInput(RELAY_NN_DENSE_OUT_SIZE, RELAY_NN_SIZE_BW);
+  m.NewBvInput(RELAY_NN_DENSE_BATCH, RELAY_NN_SIZE_BW);
+
+  m.NewBvInput(RELAY_NN_DENSE_INPUT_ADDR, RELAY_NN_ADDR_BW);
+  m.NewBvInput(RELAY_NN_DENSE_WEIGHT_ADDR, RELAY_NN_ADDR_BW);
+  m.NewBvInput(RELAY_NN_DENSE_BIAS_ADDR, RELAY_NN_ADDR_BW);
+  m.NewBvInput(RELAY_NN_DENSE_OUTPUT_ADDR, RELAY_NN_ADDR_BW);
+
+  m.NewBvInput(RELAY_NN_DENSE_INPUT_STRIDE, RELAY_NN_ADDR_BW);
+  m.NewBvInput(RELAY_NN_DENSE_OUTPUT_STRIDE, RELAY_NN_ADDR_BW);
+
+  m.NewBvInput(RELAY_NN_DENSE_ACCUMULATE, RELAY_FLAG_BW);
+  m.NewBvInput(RELAY_NN_DENSE_SKIP_BIAS, RELAY_FLAG_BW);
+  m.NewBvInput(RELAY_NN_DENSE_BLOCK, RELAY_NN_SIZE_BW);
+
+  /**** Relay vector op input ****/
+  m.NewBvInput(RELAY_VECTOR_FUNC_OPCODE, RELAY_VECTOR_OPCODE_BW);
+  m.NewBvInput(RELAY_VECTOR_FUNC_SIZE, RELAY_VECTOR_OP_SIZE_BW);
+
+  m.NewBvInput(RELAY_VECTOR_FUNC_OP0_ADDR, RELAY_VECTOR_ADDR_BW);
+  m.NewBvInput(RELAY_VECTOR_FUNC_OP1_ADDR, RELAY_VECTOR_ADDR_BW);
+  m.NewBvInput(RELAY_VECTOR_FUNC_OUTPUT_ADDR, RELAY_VECTOR_ADDR_BW);
+
+  m.NewBvInput(RELAY_VECTOR_FUNC_OP0_STRIDE, RELAY_VECTOR_ADDR_BW);
+  m.NewBvInput(RELAY_VECTOR_FUNC_OP1_STRIDE, RELAY_VECTOR_ADDR_BW);
+  m.NewBvInput(RELAY_VECTOR_FUNC_OUTPUT_STRIDE, RELAY_VECTOR_ADDR_BW);
 }
 
 } // namespace relay
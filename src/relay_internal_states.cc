@@ -58,10 +58,61 @@ void DefineInternalState(Ila& m) {
   m.NewBvState(MAXPOOLING_DATA_OUT_HEIGHT, MAXPOOLING_DATA_OUT_HEIGHT_BITWIDTH);
   m.NewBvState(MAXPOOLING_DATA_OUT_WIDTH, MAXPOOLING_DATA_OUT_WIDTH_BITWIDTH);
 
+  // latched function arguments
+  m.NewBvState(MAXPOOLING_DATA_IN_HEIGHT, MAXPOOLING_DATA_IN_HEIGHT_BITWIDTH);
+  m.NewBvState(MAXPOOLING_DATA_IN_WIDTH, MAXPOOLING_DATA_IN_WIDTH_BITWIDTH);
+  m.NewBvState(MAXPOOLING_POOL_Y, MAXPOOLING_POOL_Y_BITWIDTH);
+  m.NewBvState(MAXPOOLING_POOL_X, MAXPOOLING_POOL_X_BITWIDTH);
+  m.NewBvState(MAXPOOLING_STRIDE_Y, MAXPOOLING_STRIDE_Y_BITWIDTH);
+  m.NewBvState(MAXPOOLING_STRIDE_X, MAXPOOLING_STRIDE_X_BITWIDTH);
+  m.NewBvState(MAXPOOLING_PAD_Y, MAXPOOLING_PAD_Y_BITWIDTH);
+  m.NewBvState(MAXPOOLING_PAD_X, MAXPOOLING_PAD_X_BITWIDTH);
+  m.NewBvState(MAXPOOLING_OUT_ROW_STRIDE, MAXPOOLING_OUT_ROW_STRIDE_BITWIDTH);
+  m.NewBvState(MAXPOOLING_OUT_PLANE_STRIDE,
+               MAXPOOLING_OUT_PLANE_STRIDE_BITWIDTH);
+  m.NewBvState(MAXPOOLING_IN_PLANE_STRIDE, MAXPOOLING_IN_PLANE_STRIDE_BITWIDTH);
+  m.NewBvState(MAXPOOLING_MODE, MAXPOOLING_MODE_BITWIDTH);
+
+  // batch/channel plane loop
+  m.NewBvState(MAXPOOLING_PLANE_NUM, MAXPOOLING_PLANE_NUM_BITWIDTH);
+  m.NewBvState(MAXPOOLING_PLANE_CNTR, MAXPOOLING_PLANE_CNTR_BITWIDTH);
+  m.NewBvState(MAXPOOLING_IN_PLANE_BASE, MAXPOOLING_IN_PLANE_BASE_BITWIDTH);
+  m.NewBvState(MAXPOOLING_OUT_PLANE_BASE, MAXPOOLING_OUT_PLANE_BASE_BITWIDTH);
+
+  // row/column pass counters of the separable mode
+  m.NewBvState(MAXPOOLING_SEP_NEXT_ROW, MAXPOOLING_SEP_NEXT_ROW_BITWIDTH);
+  m.NewBvState(MAXPOOLING_SEP_X, MAXPOOLING_SEP_X_BITWIDTH);
+  m.NewBvState(MAXPOOLING_SEP_OFFSET, MAXPOOLING_SEP_OFFSET_BITWIDTH);
+  m.NewBvState(MAXPOOLING_SEP_IN_X, MAXPOOLING_SEP_IN_X_BITWIDTH);
+  m.NewBvState(MAXPOOLING_SEP_ROW_ADDR, MAXPOOLING_SEP_ROW_ADDR_BITWIDTH);
+  m.NewBvState(MAXPOOLING_SEP_RING_ADDR, MAXPOOLING_SEP_RING_ADDR_BITWIDTH);
+  m.NewBvState(MAXPOOLING_SEP_COL_ADDR, MAXPOOLING_SEP_COL_ADDR_BITWIDTH);
+  m.NewBvState(MAXPOOLING_SEP_RING_SIZE, MAXPOOLING_SEP_RING_SIZE_BITWIDTH);
+
+  // window address generation of all modes
+  m.NewBvState(MAXPOOLING_WIN_X, MAXPOOLING_WIN_X_BITWIDTH);
+  m.NewBvState(MAXPOOLING_WIN_Y, MAXPOOLING_WIN_Y_BITWIDTH);
+  m.NewBvState(MAXPOOLING_WIN_ROW_ADDR, MAXPOOLING_WIN_ROW_ADDR_BITWIDTH);
+  m.NewBvState(MAXPOOLING_IN_ROW_STEP, MAXPOOLING_IN_ROW_STEP_BITWIDTH);
+  m.NewBvState(MAXPOOLING_OUT_ROW_ADDR, MAXPOOLING_OUT_ROW_ADDR_BITWIDTH);
+  m.NewBvState(MAXPOOLING_ELEM_DX, MAXPOOLING_ELEM_DX_BITWIDTH);
+  m.NewBvState(MAXPOOLING_ELEM_DY, MAXPOOLING_ELEM_DY_BITWIDTH);
+  m.NewBvState(MAXPOOLING_ELEM_X, MAXPOOLING_ELEM_X_BITWIDTH);
+  m.NewBvState(MAXPOOLING_ELEM_Y, MAXPOOLING_ELEM_Y_BITWIDTH);
+  m.NewBvState(MAXPOOLING_ELEM_ROW_ADDR, MAXPOOLING_ELEM_ROW_ADDR_BITWIDTH);
+
   /**** RELAY LSTM states ****/
   m.NewBvState(RELAY_LSTM_START, RELAY_LSTM_FLAG_BW);
   m.NewBvState(RELAY_LSTM_STATE, RELAY_LSTM_STATE_BW);
   m.NewBvState(RELAY_LSTM_RETURN_STATE, RELAY_LSTM_STATE_BW);
+  m.NewBvState(RELAY_LSTM_CELL_CNTR, RELAY_VECTOR_SIZE_BW);
+
+  m.NewBvState(RELAY_LSTM_STEP_CNTR, RELAY_VECTOR_SIZE_BW);
+  m.NewBvState(RELAY_LSTM_STEP_INPUT_ADDR, RELAY_LSTM_ADDR_BW);
+  m.NewBvState(RELAY_LSTM_STEP_CELL_ADDR, RELAY_LSTM_ADDR_BW);
+  m.NewBvState(RELAY_LSTM_STEP_NEXT_CELL_ADDR, RELAY_LSTM_ADDR_BW);
+  m.NewBvState(RELAY_LSTM_STEP_HIDDEN_ADDR, RELAY_LSTM_ADDR_BW);
+  m.NewBvState(RELAY_LSTM_STEP_NEXT_HIDDEN_ADDR, RELAY_LSTM_ADDR_BW);
 
   /**** RELAY vector op states ****/
   m.NewBvState(RELAY_VECTOR_OP_SIZE, RELAY_VECTOR_OP_SIZE_BW);
@@ -71,17 +122,13 @@ void DefineInternalState(Ila& m) {
   m.NewBvState(RELAY_VECTOR_OP1_ADDR, RELAY_VECTOR_ADDR_BW);
   m.NewBvState(RELAY_VECTOR_OUTPUT_ADDR, RELAY_VECTOR_ADDR_BW);
 
-  m.NewBvState(RELAY_VECTOR_ADD_ENABLE, RELAY_FLAG_BW);
-  m.NewBvState(RELAY_VECTOR_ADD_START, RELAY_FLAG_BW);
-
-  m.NewBvState(RELAY_VECTOR_MULTIPLY_ENABLE, RELAY_FLAG_BW);
-  m.NewBvState(RELAY_VECTOR_MULTIPLY_START, RELAY_FLAG_BW);
+  m.NewBvState(RELAY_VECTOR_OP0_STRIDE, RELAY_VECTOR_ADDR_BW);
+  m.NewBvState(RELAY_VECTOR_OP1_STRIDE, RELAY_VECTOR_ADDR_BW);
+  m.NewBvState(RELAY_VECTOR_OUTPUT_STRIDE, RELAY_VECTOR_ADDR_BW);
 
-  m.NewBvState(RELAY_VECTOR_SIGMOID_ENABLE, RELAY_FLAG_BW);
-  m.NewBvState(RELAY_VECTOR_SIGMOID_START, RELAY_FLAG_BW);
-
-  m.NewBvState(RELAY_VECTOR_TANH_ENABLE, RELAY_FLAG_BW);
-  m.NewBvState(RELAY_VECTOR_TANH_START, RELAY_FLAG_BW);
+  m.NewBvState(RELAY_VECTOR_OP_ENABLE, RELAY_FLAG_BW);
+  m.NewBvState(RELAY_VECTOR_OP_START, RELAY_FLAG_BW);
+  m.NewBvState(RELAY_VECTOR_OPCODE, RELAY_VECTOR_OPCODE_BW);
 
   /**** RELAY nn dense states ****/
   m.NewBvState(RELAY_NN_DENSE_ENABLE, RELAY_FLAG_BW);
@@ -94,12 +141,21 @@ void DefineInternalState(Ila& m) {
 
   m.NewBvState(RELAY_NN_INPUT_WRAP_AROUND, RELAY_NN_SIZE_BW);
 
+  m.NewBvState(RELAY_NN_BATCH_SIZE, RELAY_NN_SIZE_BW);
+  m.NewBvState(RELAY_NN_INPUT_BATCH_STRIDE, RELAY_NN_ADDR_BW);
+  m.NewBvState(RELAY_NN_OUTPUT_BATCH_STRIDE, RELAY_NN_ADDR_BW);
+
+  m.NewBvState(RELAY_NN_ACCUMULATE, RELAY_FLAG_BW);
+  m.NewBvState(RELAY_NN_SKIP_BIAS, RELAY_FLAG_BW);
+  m.NewBvState(RELAY_NN_BLOCK_SIZE, RELAY_NN_SIZE_BW);
+
   m.NewBvState(RELAY_NN_WEIGHT_ADDR, RELAY_NN_ADDR_BW);
   m.NewBvState(RELAY_NN_BIAS_ADDR, RELAY_NN_ADDR_BW);
   m.NewBvState(RELAY_NN_INPUT_ADDR, RELAY_NN_ADDR_BW);
   m.NewBvState(RELAY_NN_OUTPUT_ADDR, RELAY_NN_ADDR_BW);
 
   m.NewBvState(RELAY_NN_DENSE_LOOP_CNTR, RELAY_NN_SIZE_BW);
+  m.NewBvState(RELAY_NN_DENSE_BATCH_INDEX, RELAY_NN_SIZE_BW);
 }
 
 } // namespace relay
@@ -69,6 +69,10 @@ void DefineLSTM(Ila& m) {
   auto temp_vector1_addr = m.input(RELAY_LSTM_TEMP_VECTOR1_ADDR);
   auto temp_vector2_addr = m.input(RELAY_LSTM_TEMP_VECTOR2_ADDR);
 
+  auto seq_len = m.input(RELAY_LSTM_SEQ_LEN);
+  auto input_stride = m.input(RELAY_LSTM_INPUT_STRIDE);
+  auto hidden_stride = m.input(RELAY_LSTM_HIDDEN_STRIDE);
+
 #if 0
   auto in_gate_addr = m.input(LSTM_LAYER_IN_GATE_ADDR);
   auto forget_gate_addr = m.input(LSTM_LAYER_FORGET_GATE_ADDR);
@@ -86,6 +90,32 @@ void DefineLSTM(Ila& m) {
   instr.SetUpdate(state,
                   BvConst(RELAY_LSTM_DENSE_I2H_STATE, RELAY_LSTM_STATE_BW));
 
+  // set again when the last timestep is done
+  auto func_done = m.state(RELAY_FUNC_DONE);
+  instr.SetUpdate(func_done,
+                  BvConst(RELAY_FUNC_DONE_OFF, RELAY_FUNC_DONE_BITWIDTH));
+
+  // buffers of the first timestep
+  auto step_cntr = m.state(RELAY_LSTM_STEP_CNTR);
+  auto step_input_addr = m.state(RELAY_LSTM_STEP_INPUT_ADDR);
+  auto step_cell_addr = m.state(RELAY_LSTM_STEP_CELL_ADDR);
+  auto step_next_cell_addr = m.state(RELAY_LSTM_STEP_NEXT_CELL_ADDR);
+  auto step_hidden_addr = m.state(RELAY_LSTM_STEP_HIDDEN_ADDR);
+  auto step_next_hidden_addr = m.state(RELAY_LSTM_STEP_NEXT_HIDDEN_ADDR);
+
+  instr.SetUpdate(step_cntr, BvConst(0, RELAY_VECTOR_SIZE_BW));
+  instr.SetUpdate(step_input_addr, input_addr);
+  instr.SetUpdate(step_cell_addr, cell_addr);
+  instr.SetUpdate(step_next_cell_addr, next_cell_addr);
+  instr.SetUpdate(step_hidden_addr, hidden_addr);
+  instr.SetUpdate(step_next_hidden_addr, next_hidden_addr);
+
+  // the element-wise passes work on dense vectors
+  auto vector_stride = BvConst(RELAY_VECTOR_DATA_BYTES, RELAY_VECTOR_ADDR_BW);
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP0_STRIDE), vector_stride);
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP1_STRIDE), vector_stride);
+  instr.SetUpdate(m.state(RELAY_VECTOR_OUTPUT_STRIDE), vector_stride);
+
   {
     auto child = m.NewChild(RELAY_LSTM_MATRIX_VECTOR);
     auto child_started = (flag_start == RELAY_LSTM_FLAG_ON);
@@ -96,6 +126,10 @@ void DefineLSTM(Ila& m) {
     auto dense_input_size = m.state(RELAY_NN_INPUT_SIZE);
     auto dense_output_size = m.state(RELAY_NN_OUTPUT_SIZE);
     auto dense_input_wrap_around = m.state(RELAY_NN_INPUT_WRAP_AROUND);
+    auto dense_batch_size = m.state(RELAY_NN_BATCH_SIZE);
+    auto dense_accumulate = m.state(RELAY_NN_ACCUMULATE);
+    auto dense_skip_bias = m.state(RELAY_NN_SKIP_BIAS);
+    auto dense_block_size = m.state(RELAY_NN_BLOCK_SIZE);
 
     auto dense_weight_addr = m.state(RELAY_NN_WEIGHT_ADDR);
     auto dense_bias_addr = m.state(RELAY_NN_BIAS_ADDR);
@@ -104,6 +138,7 @@ void DefineLSTM(Ila& m) {
 
     auto dense_state = m.state(RELAY_NN_DENSE_STATE);
     auto return_state = m.state(RELAY_LSTM_RETURN_STATE);
+    auto cell_cntr = m.state(RELAY_LSTM_CELL_CNTR);
 
     {
       // setup matrix-vector multiplication for I2H
@@ -122,16 +157,24 @@ void DefineLSTM(Ila& m) {
       i2h_instr.SetUpdate(dense_input_wrap_around,
                           BvConst(0, RELAY_VECTOR_SIZE_BW));
       i2h_instr.SetUpdate(dense_output_size, layer_out_size * 4);
+      i2h_instr.SetUpdate(dense_batch_size, BvConst(1, RELAY_NN_SIZE_BW));
+      i2h_instr.SetUpdate(dense_block_size,
+                          BvConst(RELAY_LSTM_DENSE_BLOCK, RELAY_NN_SIZE_BW));
 
       i2h_instr.SetUpdate(dense_weight_addr, i2h_weight_addr);
       i2h_instr.SetUpdate(dense_bias_addr, i2h_bias_addr);
-      i2h_instr.SetUpdate(dense_input_addr, input_addr);
-      i2h_instr.SetUpdate(dense_output_addr, temp_vector0_addr);
+      i2h_instr.SetUpdate(dense_input_addr, step_input_addr);
+      i2h_instr.SetUpdate(dense_output_addr, temp_vector2_addr);
+      i2h_instr.SetUpdate(dense_accumulate,
+                          BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
+      i2h_instr.SetUpdate(dense_skip_bias,
+                          BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
       i2h_instr.SetUpdate(return_state, BvConst(RELAY_LSTM_DENSE_H2H_STATE,
                                                 RELAY_LSTM_STATE_BW));
     }
     {
-      // setup matrix-vector multiplication for H2H
+      // setup matrix-vector multiplication for H2H, accumulated onto the I2H
+      // result in temp2
       auto h2h_instr = child.NewInstr(RELAY_LSTM_DENSE_H2H_INSTR);
       h2h_instr.SetDecode(
           child_started &
@@ -148,48 +191,78 @@ void DefineLSTM(Ila& m) {
       h2h_instr.SetUpdate(dense_input_wrap_around,
                           BvConst(0, RELAY_VECTOR_SIZE_BW));
       h2h_instr.SetUpdate(dense_output_size, layer_out_size * 4);
+      h2h_instr.SetUpdate(dense_batch_size, BvConst(1, RELAY_NN_SIZE_BW));
+      h2h_instr.SetUpdate(dense_block_size,
+                          BvConst(RELAY_LSTM_DENSE_BLOCK, RELAY_NN_SIZE_BW));
 
       h2h_instr.SetUpdate(dense_weight_addr, h2h_weight_addr);
       h2h_instr.SetUpdate(dense_bias_addr, h2h_bias_addr);
-      h2h_instr.SetUpdate(dense_input_addr, hidden_addr);
-      h2h_instr.SetUpdate(dense_output_addr, temp_vector1_addr);
-      h2h_instr.SetUpdate(return_state, BvConst(RELAY_LSTM_ADD_DENSE_STATE,
-                                                RELAY_LSTM_STATE_BW));
+      h2h_instr.SetUpdate(dense_input_addr, step_hidden_addr);
+      h2h_instr.SetUpdate(dense_output_addr, temp_vector2_addr);
+      h2h_instr.SetUpdate(dense_accumulate,
+                          BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
+      h2h_instr.SetUpdate(dense_skip_bias,
+                          BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
+      h2h_instr.SetUpdate(cell_cntr, BvConst(0, RELAY_VECTOR_SIZE_BW));
+      h2h_instr.SetUpdate(
+          return_state,
+          BvConst(RELAY_LSTM_FUSED_CELL ? RELAY_LSTM_FUSED_CELL_STATE
+                                        : RELAY_LSTM_SIGMOID_STATE,
+                  RELAY_LSTM_STATE_BW));
     }
 
-    auto vadd_enable = m.state(RELAY_VECTOR_ADD_ENABLE);
-    auto vadd_size = m.state(RELAY_VECTOR_OP_SIZE);
-    auto vadd_op0_addr = m.state(RELAY_VECTOR_ADD_OP0_ADDR);
-    auto vadd_op1_addr = m.state(RELAY_VECTOR_ADD_OP1_ADDR);
-    auto vadd_output_addr = m.state(RELAY_VECTOR_ADD_OUTPUT_ADDR);
-    auto vadd_start = m.state(RELAY_VECTOR_ADD_START);
-
     {
-      // setup vector-add of temp0 and temp1
-      auto add_dense_instr = child.NewInstr(RELAY_LSTM_ADD_DENSE_INSTR);
-      add_dense_instr.SetDecode(
+      // one element of every gate per step: read the dense outputs (temp2),
+      // apply the activations and write next cell/hidden directly, without
+      // the temp vector passes
+      auto fused_cell_instr = child.NewInstr(RELAY_LSTM_FUSED_CELL_INSTR);
+      fused_cell_instr.SetDecode(
           child_started &
-          (state == BvConst(RELAY_LSTM_ADD_DENSE_STATE, RELAY_LSTM_STATE_BW)));
-
-      add_dense_instr.SetUpdate(state,
-                                BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
-      add_dense_instr.SetUpdate(vadd_enable,
-                                BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      add_dense_instr.SetUpdate(vadd_start,
-                                BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      add_dense_instr.SetUpdate(vadd_size, layer_out_size * 4);
-      add_dense_instr.SetUpdate(vadd_op0_addr, temp_vector0_addr);
-      add_dense_instr.SetUpdate(vadd_op1_addr, temp_vector1_addr);
-      add_dense_instr.SetUpdate(vadd_output_addr, temp_vector2_addr);
-      add_dense_instr.SetUpdate(
-          return_state, BvConst(RELAY_LSTM_SIGMOID_STATE, RELAY_LSTM_STATE_BW));
+          (state == BvConst(RELAY_LSTM_FUSED_CELL_STATE, RELAY_LSTM_STATE_BW)));
+
+      auto memory = m.state(RELAY_MEMORY);
+      auto elem_offset = cell_cntr * RELAY_VECTOR_DATA_BYTES;
+      auto slice_size = layer_out_size * RELAY_VECTOR_DATA_BYTES;
+
+      // gate slices in order: input, forget, "cell input", output
+      auto gate = [&](int slice) {
+        auto offset = elem_offset + slice_size * slice;
+        return RELAY_LOAD_WORD(memory, temp_vector2_addr + offset);
+      };
+      auto in_gate = bv_sigmoid(gate(0));
+      auto forget_gate = bv_sigmoid(gate(1));
+      auto cell_in = bv_tanh(gate(2));
+      auto out_gate = bv_sigmoid(gate(3));
+
+      auto cell = RELAY_LOAD_WORD(memory, step_cell_addr + elem_offset);
+      auto next_cell =
+          bv_add(bv_multiply(forget_gate, cell), bv_multiply(in_gate, cell_in));
+      auto next_hidden = bv_multiply(out_gate, bv_tanh(next_cell));
+
+      auto next_memory = RELAY_STORE_WORD(
+          RELAY_STORE_WORD(memory, step_next_cell_addr + elem_offset,
+                           next_cell),
+          step_next_hidden_addr + elem_offset, next_hidden);
+
+      auto next_cell_cntr = cell_cntr + BvConst(1, RELAY_VECTOR_SIZE_BW);
+      auto next_state =
+          Ite(next_cell_cntr != layer_out_size, state,
+              BvConst(RELAY_LSTM_NEXT_STEP_STATE, RELAY_LSTM_STATE_BW));
+
+      fused_cell_instr.SetUpdate(memory, next_memory);
+      fused_cell_instr.SetUpdate(cell_cntr, next_cell_cntr);
+      fused_cell_instr.SetUpdate(state, next_state);
     }
 
-    auto vsig_enable = m.state(RELAY_VECTOR_SIGMOID_ENABLE);
-    auto vsig_size = m.state(RELAY_VECTOR_OP_SIZE);
-    auto vsig_op0_addr = m.state(RELAY_VECTOR_SIGMOID_OP0_ADDR);
-    auto vsig_output_addr = m.state(RELAY_VECTOR_SIGMOID_OUTPUT_ADDR);
-    auto vsig_start = m.state(RELAY_VECTOR_SIGMOID_START);
+    // all element-wise passes go through the shared vector-op engine
+    auto vop_enable = m.state(RELAY_VECTOR_OP_ENABLE);
+    auto vop_start = m.state(RELAY_VECTOR_OP_START);
+    auto vop_opcode = m.state(RELAY_VECTOR_OPCODE);
+    auto vop_size = m.state(RELAY_VECTOR_OP_SIZE);
+    auto vop_op0_addr = m.state(RELAY_VECTOR_OP0_ADDR);
+    auto vop_op1_addr = m.state(RELAY_VECTOR_OP1_ADDR);
+    auto vop_output_addr = m.state(RELAY_VECTOR_OUTPUT_ADDR);
+
     {
       // setup vector-sigmoid on temp2 (first 2 slices,
       // input/forget/in-trans/output gates) output => temp0
@@ -200,22 +273,19 @@ void DefineLSTM(Ila& m) {
 
       sigmoid_instr.SetUpdate(state,
                               BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
-      sigmoid_instr.SetUpdate(vsig_enable,
+      sigmoid_instr.SetUpdate(vop_enable,
                               BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      sigmoid_instr.SetUpdate(vsig_start,
+      sigmoid_instr.SetUpdate(vop_start,
                               BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      sigmoid_instr.SetUpdate(vsig_size, layer_out_size * 2);
-      sigmoid_instr.SetUpdate(vsig_op0_addr, temp_vector2_addr);
-      sigmoid_instr.SetUpdate(vsig_output_addr, temp_vector0_addr);
+      sigmoid_instr.SetUpdate(vop_opcode, BvConst(RELAY_VECTOR_OPCODE_SIGMOID,
+                                                  RELAY_VECTOR_OPCODE_BW));
+      sigmoid_instr.SetUpdate(vop_size, layer_out_size * 2);
+      sigmoid_instr.SetUpdate(vop_op0_addr, temp_vector2_addr);
+      sigmoid_instr.SetUpdate(vop_output_addr, temp_vector0_addr);
       sigmoid_instr.SetUpdate(return_state, BvConst(RELAY_LSTM_CELL_TANH_STATE,
                                                     RELAY_LSTM_STATE_BW));
     }
 
-    auto vtanh_enable = m.state(RELAY_VECTOR_TANH_ENABLE);
-    auto vtanh_size = m.state(RELAY_VECTOR_OP_SIZE);
-    auto vtanh_op0_addr = m.state(RELAY_VECTOR_TANH_OP0_ADDR);
-    auto vtanh_output_addr = m.state(RELAY_VECTOR_TANH_OUTPUT_ADDR);
-    auto vtanh_start = m.state(RELAY_VECTOR_TANH_START);
     {
       // setup vector-tanh on temp2 (3rd slice, "cell input activation")
       // output => temp0 (4th slice)
@@ -227,14 +297,15 @@ void DefineLSTM(Ila& m) {
       auto addr_offset = layer_out_size * (RELAY_VECTOR_DATA_BYTES * 2);
       cell_tanh_instr.SetUpdate(state,
                                 BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
-      cell_tanh_instr.SetUpdate(vtanh_enable,
+      cell_tanh_instr.SetUpdate(vop_enable,
                                 BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      cell_tanh_instr.SetUpdate(vtanh_start,
+      cell_tanh_instr.SetUpdate(vop_start,
                                 BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      cell_tanh_instr.SetUpdate(vtanh_size, layer_out_size);
-      cell_tanh_instr.SetUpdate(vtanh_op0_addr,
-                                temp_vector2_addr + addr_offset);
-      cell_tanh_instr.SetUpdate(vtanh_output_addr,
+      cell_tanh_instr.SetUpdate(vop_opcode, BvConst(RELAY_VECTOR_OPCODE_TANH,
+                                                    RELAY_VECTOR_OPCODE_BW));
+      cell_tanh_instr.SetUpdate(vop_size, layer_out_size);
+      cell_tanh_instr.SetUpdate(vop_op0_addr, temp_vector2_addr + addr_offset);
+      cell_tanh_instr.SetUpdate(vop_output_addr,
                                 temp_vector0_addr + addr_offset);
       cell_tanh_instr.SetUpdate(
           return_state,
@@ -252,26 +323,23 @@ void DefineLSTM(Ila& m) {
       auto addr_offset = layer_out_size * (RELAY_VECTOR_DATA_BYTES * 3);
       output_gate_instr.SetUpdate(
           state, BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
-      output_gate_instr.SetUpdate(vsig_enable,
+      output_gate_instr.SetUpdate(vop_enable,
                                   BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      output_gate_instr.SetUpdate(vsig_start,
+      output_gate_instr.SetUpdate(vop_start,
                                   BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      output_gate_instr.SetUpdate(vsig_size, layer_out_size);
-      output_gate_instr.SetUpdate(vsig_op0_addr,
+      output_gate_instr.SetUpdate(
+          vop_opcode,
+          BvConst(RELAY_VECTOR_OPCODE_SIGMOID, RELAY_VECTOR_OPCODE_BW));
+      output_gate_instr.SetUpdate(vop_size, layer_out_size);
+      output_gate_instr.SetUpdate(vop_op0_addr,
                                   temp_vector2_addr + addr_offset);
-      output_gate_instr.SetUpdate(vsig_output_addr,
+      output_gate_instr.SetUpdate(vop_output_addr,
                                   temp_vector0_addr + addr_offset);
       output_gate_instr.SetUpdate(
           return_state,
           BvConst(RELAY_LSTM_FORGET_GATE_STATE, RELAY_LSTM_STATE_BW));
     }
 
-    auto vmul_enable = m.state(RELAY_VECTOR_MULTIPLY_ENABLE);
-    auto vmul_size = m.state(RELAY_VECTOR_OP_SIZE);
-    auto vmul_op0_addr = m.state(RELAY_VECTOR_MULTIPLY_OP0_ADDR);
-    auto vmul_op1_addr = m.state(RELAY_VECTOR_MULTIPLY_OP1_ADDR);
-    auto vmul_output_addr = m.state(RELAY_VECTOR_MULTIPLY_OUTPUT_ADDR);
-    auto vmul_start = m.state(RELAY_VECTOR_MULTIPLY_START);
     {
       // setup vector-multiply between forget gate (2nd slice in temp 0) and
       // cell state save into temp 1 (1st slice)
@@ -284,16 +352,19 @@ void DefineLSTM(Ila& m) {
       forget_gate_instr.SetUpdate(
           state, BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
 
-      forget_gate_instr.SetUpdate(vmul_enable,
+      forget_gate_instr.SetUpdate(vop_enable,
                                   BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      forget_gate_instr.SetUpdate(vmul_start,
+      forget_gate_instr.SetUpdate(vop_start,
                                   BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      forget_gate_instr.SetUpdate(vmul_size, layer_out_size);
       forget_gate_instr.SetUpdate(
-          vmul_op0_addr,
+          vop_opcode,
+          BvConst(RELAY_VECTOR_OPCODE_MULTIPLY, RELAY_VECTOR_OPCODE_BW));
+      forget_gate_instr.SetUpdate(vop_size, layer_out_size);
+      forget_gate_instr.SetUpdate(
+          vop_op0_addr,
           temp_vector0_addr + (layer_out_size * RELAY_VECTOR_DATA_BYTES));
-      forget_gate_instr.SetUpdate(vmul_op1_addr, cell_addr);
-      forget_gate_instr.SetUpdate(vmul_output_addr, temp_vector1_addr);
+      forget_gate_instr.SetUpdate(vop_op1_addr, step_cell_addr);
+      forget_gate_instr.SetUpdate(vop_output_addr, temp_vector1_addr);
       forget_gate_instr.SetUpdate(
           return_state,
           BvConst(RELAY_LSTM_INPUT_GATE_STATE, RELAY_LSTM_STATE_BW));
@@ -314,17 +385,20 @@ void DefineLSTM(Ila& m) {
       input_gate_instr.SetUpdate(
           state, BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
 
-      input_gate_instr.SetUpdate(vmul_enable,
+      input_gate_instr.SetUpdate(vop_enable,
                                  BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      input_gate_instr.SetUpdate(vmul_start,
+      input_gate_instr.SetUpdate(vop_start,
                                  BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      input_gate_instr.SetUpdate(vmul_size, layer_out_size);
-      input_gate_instr.SetUpdate(vmul_op0_addr, temp_vector0_addr);
       input_gate_instr.SetUpdate(
-          vmul_op1_addr,
+          vop_opcode,
+          BvConst(RELAY_VECTOR_OPCODE_MULTIPLY, RELAY_VECTOR_OPCODE_BW));
+      input_gate_instr.SetUpdate(vop_size, layer_out_size);
+      input_gate_instr.SetUpdate(vop_op0_addr, temp_vector0_addr);
+      input_gate_instr.SetUpdate(
+          vop_op1_addr,
           temp_vector0_addr + (layer_out_size * RELAY_VECTOR_DATA_BYTES * 2));
       input_gate_instr.SetUpdate(
-          vmul_output_addr,
+          vop_output_addr,
           temp_vector1_addr + (layer_out_size * RELAY_VECTOR_DATA_BYTES));
       input_gate_instr.SetUpdate(
           return_state,
@@ -341,16 +415,18 @@ void DefineLSTM(Ila& m) {
 
       next_cell_instr.SetUpdate(state,
                                 BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
-      next_cell_instr.SetUpdate(vadd_enable,
+      next_cell_instr.SetUpdate(vop_enable,
                                 BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      next_cell_instr.SetUpdate(vadd_start,
+      next_cell_instr.SetUpdate(vop_start,
                                 BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      next_cell_instr.SetUpdate(vadd_size, layer_out_size);
-      next_cell_instr.SetUpdate(vadd_op0_addr, temp_vector1_addr);
-      next_cell_instr.SetUpdate(vadd_op1_addr,
+      next_cell_instr.SetUpdate(vop_opcode, BvConst(RELAY_VECTOR_OPCODE_ADD,
+                                                    RELAY_VECTOR_OPCODE_BW));
+      next_cell_instr.SetUpdate(vop_size, layer_out_size);
+      next_cell_instr.SetUpdate(vop_op0_addr, temp_vector1_addr);
+      next_cell_instr.SetUpdate(vop_op1_addr,
                                 temp_vector1_addr +
                                     layer_out_size * RELAY_VECTOR_DATA_BYTES);
-      next_cell_instr.SetUpdate(vadd_output_addr, next_cell_addr);
+      next_cell_instr.SetUpdate(vop_output_addr, step_next_cell_addr);
       next_cell_instr.SetUpdate(
           return_state,
           BvConst(RELAY_LSTM_NEXT_CELL_TANH_STATE, RELAY_LSTM_STATE_BW));
@@ -367,14 +443,17 @@ void DefineLSTM(Ila& m) {
 
       next_cell_tanh_instr.SetUpdate(
           state, BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
-      next_cell_tanh_instr.SetUpdate(vtanh_enable,
+      next_cell_tanh_instr.SetUpdate(vop_enable,
                                      BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      next_cell_tanh_instr.SetUpdate(vtanh_start,
+      next_cell_tanh_instr.SetUpdate(vop_start,
                                      BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      next_cell_tanh_instr.SetUpdate(vtanh_size, layer_out_size);
-      next_cell_tanh_instr.SetUpdate(vtanh_op0_addr, next_cell_addr);
       next_cell_tanh_instr.SetUpdate(
-          vtanh_output_addr,
+          vop_opcode,
+          BvConst(RELAY_VECTOR_OPCODE_TANH, RELAY_VECTOR_OPCODE_BW));
+      next_cell_tanh_instr.SetUpdate(vop_size, layer_out_size);
+      next_cell_tanh_instr.SetUpdate(vop_op0_addr, step_next_cell_addr);
+      next_cell_tanh_instr.SetUpdate(
+          vop_output_addr,
           temp_vector1_addr + layer_out_size * (RELAY_VECTOR_DATA_BYTES * 2));
       next_cell_tanh_instr.SetUpdate(
           return_state, BvConst(RELAY_LSTM_OUTPUT_STATE, RELAY_LSTM_STATE_BW));
@@ -391,20 +470,56 @@ void DefineLSTM(Ila& m) {
       output_instr.SetUpdate(state,
                              BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
 
-      output_instr.SetUpdate(vmul_enable,
-                             BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-      output_instr.SetUpdate(vmul_start,
-                             BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
-      output_instr.SetUpdate(vmul_size, layer_out_size);
+      output_instr.SetUpdate(vop_enable, BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
+      output_instr.SetUpdate(vop_start, BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
+      output_instr.SetUpdate(vop_opcode, BvConst(RELAY_VECTOR_OPCODE_MULTIPLY,
+                                                 RELAY_VECTOR_OPCODE_BW));
+      output_instr.SetUpdate(vop_size, layer_out_size);
       output_instr.SetUpdate(
-          vmul_op0_addr,
+          vop_op0_addr,
           temp_vector0_addr + layer_out_size * (RELAY_VECTOR_DATA_BYTES * 3));
       output_instr.SetUpdate(
-          vmul_op1_addr,
+          vop_op1_addr,
           temp_vector1_addr + layer_out_size * (RELAY_VECTOR_DATA_BYTES * 2));
-      output_instr.SetUpdate(vmul_output_addr, next_hidden_addr);
+      output_instr.SetUpdate(vop_output_addr, step_next_hidden_addr);
       output_instr.SetUpdate(
-          return_state, BvConst(RELAY_LSTM_END_STATE, RELAY_LSTM_STATE_BW));
+          return_state,
+          BvConst(RELAY_LSTM_NEXT_STEP_STATE, RELAY_LSTM_STATE_BW));
+    }
+
+    {
+      // advance to the next timestep: the outputs of this step become the
+      // cell/hidden inputs of the next one
+      auto next_step_instr = child.NewInstr(RELAY_LSTM_NEXT_STEP_INSTR);
+      next_step_instr.SetDecode(
+          child_started &
+          (state == BvConst(RELAY_LSTM_NEXT_STEP_STATE, RELAY_LSTM_STATE_BW)));
+
+      auto next_step_cntr = step_cntr + BvConst(1, RELAY_VECTOR_SIZE_BW);
+      auto seq_done = (next_step_cntr == seq_len) |
+                      (seq_len == BvConst(0, RELAY_VECTOR_SIZE_BW));
+      auto hidden_seq = (hidden_stride != BvConst(0, RELAY_LSTM_ADDR_BW));
+
+      auto next_state =
+          Ite(seq_done, BvConst(RELAY_LSTM_END_STATE, RELAY_LSTM_STATE_BW),
+              BvConst(RELAY_LSTM_DENSE_I2H_STATE, RELAY_LSTM_STATE_BW));
+
+      next_step_instr.SetUpdate(state, next_state);
+      next_step_instr.SetUpdate(
+          func_done,
+          Ite(seq_done,
+              BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH),
+              func_done));
+      next_step_instr.SetUpdate(step_cntr, next_step_cntr);
+      next_step_instr.SetUpdate(step_input_addr,
+                                step_input_addr + input_stride);
+      next_step_instr.SetUpdate(step_cell_addr, step_next_cell_addr);
+      next_step_instr.SetUpdate(step_next_cell_addr, step_cell_addr);
+      next_step_instr.SetUpdate(step_hidden_addr, step_next_hidden_addr);
+      next_step_instr.SetUpdate(
+          step_next_hidden_addr,
+          Ite(hidden_seq, step_next_hidden_addr + hidden_stride,
+              step_hidden_addr));
     }
   }
 }
@@ -28,6 +28,8 @@
 // 0), layout='NCHW', ceil_mode=False)
 // This file contains the model of maxpooling 2d instruction of Relay IR
 
+#include <vector>
+
 #include <ilang/util/log.h>
 
 #include <relay/relay_top.h>
@@ -39,6 +41,25 @@ namespace relay {
 
 void AddChild_Loop_Op(Ila& m);
 void AddChild_Find_Max(Ila& m);
+void AddChild_Separable(Ila& m);
+void AddChild_Lanes(Ila& m);
+void SetMaxpoolingPlaneOrigin(Ila& m, InstrRef& instr, const ExprRef& in_base,
+                              const ExprRef& out_base, const ExprRef& width_in,
+                              const ExprRef& pad_y, const ExprRef& pad_x);
+void SetMaxpoolingWindowStart(Ila& m, InstrRef& instr, const ExprRef& x,
+                              const ExprRef& y, const ExprRef& row_addr);
+ExprRef SetMaxpoolingNextElem(Ila& m, InstrRef& instr);
+
+// first state of a plane for the given maxpooling mode
+ExprRef MaxpoolingStartState(const ExprRef& mode) {
+  auto start_sep = BvConst(MAXPOOLING_STATE_SEP_ROW, MAXPOOLING_STATE_BITWIDTH);
+  auto start_lanes =
+      BvConst(MAXPOOLING_STATE_LANE_MAX, MAXPOOLING_STATE_BITWIDTH);
+  auto start_direct =
+      BvConst(MAXPOOLING_STATE_FIND_MAX, MAXPOOLING_STATE_BITWIDTH);
+  return Ite(mode == MAXPOOLING_MODE_SEPARABLE, start_sep,
+             Ite(mode == MAXPOOLING_MODE_LANES, start_lanes, start_direct));
+}
 
 void DefineMaxpooling2D(Ila& m) {
 
@@ -60,11 +81,47 @@ void DefineMaxpooling2D(Ila& m) {
     auto stride_y = m.input(STRIDES_Y_IN); // 8
     auto stride_x = m.input(STRIDES_X_IN);
 
+    auto mode = m.input(MAXPOOLING_MODE_IN);
+
+    // batch and channel of 0 are taken as a single plane
+    auto batch = m.input(DATA_IN_BATCH);
+    auto channel = m.input(DATA_IN_CHANNEL);
+    auto batch_32 = Ite(batch == 0, BvConst(1, 32), batch);
+    auto channel_32 = Ite(channel == 0, BvConst(1, 32), channel);
+
+    // input plane placement, 0 is a dense H x W plane
+    auto in_plane_stride_in = m.input(MAXPOOLING_IN_PLANE_STRIDE_IN);
+    auto in_plane_stride = Ite(in_plane_stride_in == 0, height_in * width_in,
+                               in_plane_stride_in);
+
+    auto pad_y = m.input(PADDING_IN_Y);
+    auto pad_x = m.input(PADDING_IN_X);
+    auto ceil_mode = (m.input(CEIL_MODE_IN) != 0);
+
+    auto pool_y_32 = Concat(BvConst(0, 24), pool_y);
+    auto pool_x_32 = Concat(BvConst(0, 24), pool_x);
     auto stride_y_32 = Concat(BvConst(0, 24), stride_y);
     auto stride_x_32 = Concat(BvConst(0, 24), stride_x);
+    auto pad_y_32 = Concat(BvConst(0, 24), pad_y);
+    auto pad_x_32 = Concat(BvConst(0, 24), pad_x);
+
     // calculate the output tensor size
-    auto height_out_tmp = height_in / stride_y_32;
-    auto width_out_tmp = width_in / stride_x_32;
+    // floor: (in + 2 * pad - pool) / stride + 1
+    // ceil:  (in + 2 * pad - pool + stride - 1) / stride + 1
+    auto span_y = height_in + pad_y_32 + pad_y_32 - pool_y_32;
+    auto span_x = width_in + pad_x_32 + pad_x_32 - pool_x_32;
+    auto round_y = Ite(ceil_mode, stride_y_32 - 1, BvConst(0, 32));
+    auto round_x = Ite(ceil_mode, stride_x_32 - 1, BvConst(0, 32));
+    auto height_out_tmp = (span_y + round_y) / stride_y_32 + 1;
+    auto width_out_tmp = (span_x + round_x) / stride_x_32 + 1;
+
+    // output placement, the strides default to a dense NCHW output
+    auto out_base = m.input(MAXPOOLING_OUT_BASE_IN);
+    auto row_stride_in = m.input(MAXPOOLING_OUT_ROW_STRIDE_IN);
+    auto plane_stride_in = m.input(MAXPOOLING_OUT_PLANE_STRIDE_IN);
+    auto row_stride = Ite(row_stride_in == 0, width_out_tmp, row_stride_in);
+    auto plane_stride = Ite(plane_stride_in == 0, height_out_tmp * row_stride,
+                            plane_stride_in);
 
     // states used for child
     auto flag_start = m.state(MAXPOOLING_START_FLAG); // ON/OFF
@@ -82,8 +139,10 @@ void DefineMaxpooling2D(Ila& m) {
     instr.SetUpdate(flag_start,
                     BvConst(FLAG_ON, MAXPOOLING_START_FLAG_BITWIDTH));
 
-    instr.SetUpdate(
-        state, BvConst(MAXPOOLING_STATE_FIND_MAX, MAXPOOLING_STATE_BITWIDTH));
+    instr.SetUpdate(state, MaxpoolingStartState(mode));
+    // set again after the last plane
+    instr.SetUpdate(m.state(RELAY_FUNC_DONE),
+                    BvConst(RELAY_FUNC_DONE_OFF, RELAY_FUNC_DONE_BITWIDTH));
 
     instr.SetUpdate(cntr_X, BvConst(0, MAXPOOLING_X_LOOP_CNTR_BITWIDTH));
     instr.SetUpdate(cntr_Y, BvConst(0, MAXPOOLING_Y_LOOP_CNTR_BITWIDTH));
@@ -91,8 +150,38 @@ void DefineMaxpooling2D(Ila& m) {
     instr.SetUpdate(height_out, height_out_tmp);
     instr.SetUpdate(width_out, width_out_tmp);
 
+    // latch the arguments for the whole call
+    instr.SetUpdate(m.state(MAXPOOLING_DATA_IN_HEIGHT), height_in);
+    instr.SetUpdate(m.state(MAXPOOLING_DATA_IN_WIDTH), width_in);
+    instr.SetUpdate(m.state(MAXPOOLING_POOL_Y), pool_y);
+    instr.SetUpdate(m.state(MAXPOOLING_POOL_X), pool_x);
+    instr.SetUpdate(m.state(MAXPOOLING_STRIDE_Y), stride_y);
+    instr.SetUpdate(m.state(MAXPOOLING_STRIDE_X), stride_x);
+    instr.SetUpdate(m.state(MAXPOOLING_PAD_Y), pad_y);
+    instr.SetUpdate(m.state(MAXPOOLING_PAD_X), pad_x);
+    instr.SetUpdate(m.state(MAXPOOLING_OUT_ROW_STRIDE), row_stride);
+    instr.SetUpdate(m.state(MAXPOOLING_OUT_PLANE_STRIDE), plane_stride);
+    instr.SetUpdate(m.state(MAXPOOLING_IN_PLANE_STRIDE), in_plane_stride);
+    instr.SetUpdate(m.state(MAXPOOLING_MODE), mode);
+
+    instr.SetUpdate(m.state(MAXPOOLING_PLANE_NUM), batch_32 * channel_32);
+    instr.SetUpdate(m.state(MAXPOOLING_PLANE_CNTR),
+                    BvConst(0, MAXPOOLING_PLANE_CNTR_BITWIDTH));
+    instr.SetUpdate(m.state(MAXPOOLING_IN_PLANE_BASE),
+                    BvConst(0, MAXPOOLING_IN_PLANE_BASE_BITWIDTH));
+    instr.SetUpdate(m.state(MAXPOOLING_OUT_PLANE_BASE), out_base);
+
+    instr.SetUpdate(m.state(MAXPOOLING_IN_ROW_STEP), stride_y_32 * width_in);
+    instr.SetUpdate(m.state(MAXPOOLING_SEP_RING_SIZE),
+                    pool_y_32 * width_out_tmp);
+    SetMaxpoolingPlaneOrigin(m, instr,
+                             BvConst(0, MAXPOOLING_IN_PLANE_BASE_BITWIDTH),
+                             out_base, width_in, pad_y_32, pad_x_32);
+
     // add child to do the loop
     AddChild_Loop_Op(m);
+    AddChild_Separable(m);
+    AddChild_Lanes(m);
   }
 }
 
@@ -113,18 +202,21 @@ void AddChild_Loop_Op(Ila& m) {
   auto height_out = m.state(MAXPOOLING_DATA_OUT_HEIGHT);
   auto width_out = m.state(MAXPOOLING_DATA_OUT_WIDTH);
 
-  auto pool_y = m.input(POOL_SIZE_Y_IN);
-  auto pool_x = m.input(POOL_SIZE_X_IN);
+  auto out_row_stride = m.state(MAXPOOLING_OUT_ROW_STRIDE);
+  auto stride_y = Concat(BvConst(0, 24), m.state(MAXPOOLING_STRIDE_Y));
+  auto stride_x = Concat(BvConst(0, 24), m.state(MAXPOOLING_STRIDE_X));
+  auto pad_x = Concat(BvConst(0, 24), m.state(MAXPOOLING_PAD_X));
 
-  auto stride_y = m.input(STRIDES_Y_IN); // 8
-  auto stride_x = m.input(STRIDES_X_IN);
+  auto win_x = m.state(MAXPOOLING_WIN_X);
+  auto win_y = m.state(MAXPOOLING_WIN_Y);
+  auto win_row_addr = m.state(MAXPOOLING_WIN_ROW_ADDR);
+  auto in_row_step = m.state(MAXPOOLING_IN_ROW_STEP);
+  auto out_row_addr = m.state(MAXPOOLING_OUT_ROW_ADDR);
 
   // tensor memory state
   auto tensor = m.state(RELAY_TENSOR_MEM);
 
   // child states for find max
-  auto cntr_find_max = child.NewBvState(MAXPOOLING_FIND_MAX_CNTR,
-                                        MAXPOOLING_FIND_MAX_CNTR_BITWIDTH);
   auto result_max = child.NewBvState(MAXPOOLING_FIND_MAX_RESULT,
                                      MAXPOOLING_FIND_MAX_RESULT_BITWIDTH);
 
@@ -137,7 +229,7 @@ void AddChild_Loop_Op(Ila& m) {
 
     instr.SetDecode(cond_flag & cond_state);
 
-    auto end_of_X = (cntr_X == width_out);
+    auto end_of_X = (cntr_X == (width_out - 1));
 
     auto cntr_X_new =
         Ite(end_of_X, BvConst(0, MAXPOOLING_X_LOOP_CNTR_BITWIDTH), cntr_X + 1);
@@ -147,6 +239,8 @@ void AddChild_Loop_Op(Ila& m) {
         BvConst(MAXPOOLING_STATE_FIND_MAX, MAXPOOLING_STATE_BITWIDTH));
 
     instr.SetUpdate(cntr_X, cntr_X_new);
+    instr.SetUpdate(win_x, Ite(end_of_X, BvConst(0, 32) - pad_x,
+                               win_x + stride_x));
     instr.SetUpdate(state, next_state);
   }
 
@@ -167,6 +261,9 @@ void AddChild_Loop_Op(Ila& m) {
             BvConst(MAXPOOLING_STATE_FIND_MAX, MAXPOOLING_STATE_BITWIDTH));
 
     instr.SetUpdate(cntr_Y, cntr_Y_new);
+    instr.SetUpdate(win_y, win_y + stride_y);
+    instr.SetUpdate(win_row_addr, win_row_addr + in_row_step);
+    instr.SetUpdate(out_row_addr, out_row_addr + out_row_stride);
     instr.SetUpdate(state, next_state);
   }
 
@@ -182,8 +279,7 @@ void AddChild_Loop_Op(Ila& m) {
     auto next_state =
         BvConst(MAXPOOLING_STATE_FIND_MAX_CHILD, MAXPOOLING_STATE_BITWIDTH);
 
-    instr.SetUpdate(cntr_find_max,
-                    BvConst(0, MAXPOOLING_FIND_MAX_CNTR_BITWIDTH));
+    SetMaxpoolingWindowStart(m, instr, win_x, win_y, win_row_addr);
     instr.SetUpdate(state, next_state);
 
     AddChild_Find_Max(m);
@@ -196,7 +292,7 @@ void AddChild_Loop_Op(Ila& m) {
 
     instr.SetDecode(cond_flag & cond_state);
 
-    auto addr = cntr_X + cntr_Y * width_out;
+    auto addr = out_row_addr + cntr_X;
     auto next_state =
         BvConst(MAXPOOLING_STATE_VAR_UPDATE, MAXPOOLING_STATE_BITWIDTH);
 
@@ -214,11 +310,59 @@ void AddChild_Loop_Op(Ila& m) {
 
     auto done = (cntr_X == (width_out - 1) & (cntr_Y == (height_out - 1)));
     auto next_state =
-        Ite(done, BvConst(MAXPOOLING_STATE_DONE, MAXPOOLING_STATE_BITWIDTH),
+        Ite(done,
+            BvConst(MAXPOOLING_STATE_NEXT_PLANE, MAXPOOLING_STATE_BITWIDTH),
             BvConst(MAXPOOLING_STATE_INC_X, MAXPOOLING_STATE_BITWIDTH));
 
     instr.SetUpdate(state, next_state);
   }
+
+  // child instruction 6 -- move on to the next (batch, channel) plane
+  {
+    auto instr = child.NewInstr("child_next_plane");
+    auto cond_flag = (flag_start == FLAG_ON);
+    auto cond_state = (state == MAXPOOLING_STATE_NEXT_PLANE);
+
+    instr.SetDecode(cond_flag & cond_state);
+
+    auto plane_num = m.state(MAXPOOLING_PLANE_NUM);
+    auto plane_cntr = m.state(MAXPOOLING_PLANE_CNTR);
+    auto in_plane_base = m.state(MAXPOOLING_IN_PLANE_BASE);
+    auto out_plane_base = m.state(MAXPOOLING_OUT_PLANE_BASE);
+
+    auto width_in = m.state(MAXPOOLING_DATA_IN_WIDTH);
+    auto in_plane_stride = m.state(MAXPOOLING_IN_PLANE_STRIDE);
+    auto out_plane_stride = m.state(MAXPOOLING_OUT_PLANE_STRIDE);
+
+    auto last_plane = (plane_cntr == (plane_num - 1));
+
+    auto start_state = MaxpoolingStartState(m.state(MAXPOOLING_MODE));
+    auto next_state = Ite(
+        last_plane, BvConst(MAXPOOLING_STATE_DONE, MAXPOOLING_STATE_BITWIDTH),
+        start_state);
+
+    instr.SetUpdate(state, next_state);
+    auto func_done = m.state(RELAY_FUNC_DONE);
+    instr.SetUpdate(
+        func_done,
+        Ite(last_plane, BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH),
+            func_done));
+    auto in_base_next = Ite(last_plane, in_plane_base,
+                            in_plane_base + in_plane_stride);
+    auto out_base_next = Ite(last_plane, out_plane_base,
+                             out_plane_base + out_plane_stride);
+
+    instr.SetUpdate(plane_cntr, Ite(last_plane, plane_cntr, plane_cntr + 1));
+    instr.SetUpdate(in_plane_base, in_base_next);
+    instr.SetUpdate(out_plane_base, out_base_next);
+    SetMaxpoolingPlaneOrigin(
+        m, instr, in_base_next, out_base_next, width_in,
+        Concat(BvConst(0, 24), m.state(MAXPOOLING_PAD_Y)),
+        Concat(BvConst(0, 24), m.state(MAXPOOLING_PAD_X)));
+
+    instr.SetUpdate(cntr_X, BvConst(0, MAXPOOLING_X_LOOP_CNTR_BITWIDTH));
+    instr.SetUpdate(cntr_Y, BvConst(0, MAXPOOLING_Y_LOOP_CNTR_BITWIDTH));
+  }
 }
 
 void AddChild_Find_Max(Ila& m) {
@@ -230,22 +374,16 @@ void AddChild_Find_Max(Ila& m) {
   child_find_max.SetValid(state == MAXPOOLING_STATE_FIND_MAX_CHILD);
   child_find_max.SetFetch(BvConst(1, 1));
 
-  auto height_in = m.input(DATA_IN_Y); // 32
-  auto width_in = m.input(DATA_IN_X);
-
-  auto pool_y = m.input(POOL_SIZE_Y_IN);
-  auto pool_x = m.input(POOL_SIZE_X_IN); // 8
-
-  auto stride_y = m.input(STRIDES_Y_IN); // 8
-  auto stride_x = m.input(STRIDES_X_IN);
-
-  auto out_y = m.state(MAXPOOLING_Y_LOOP_CNTR);
-  auto out_x = m.state(MAXPOOLING_X_LOOP_CNTR); // 32
+  auto height_in = m.state(MAXPOOLING_DATA_IN_HEIGHT); // 32
+  auto width_in = m.state(MAXPOOLING_DATA_IN_WIDTH);
 
-  auto pool_y_16 = Concat(BvConst(0, POOL_SIZE_Y_IN_BITWIDTH), pool_y);
-  auto pool_x_16 = Concat(BvConst(0, POOL_SIZE_X_IN_BITWIDTH), pool_x);
+  // current window element
+  auto elem_dx = m.state(MAXPOOLING_ELEM_DX); // 8
+  auto elem_dy = m.state(MAXPOOLING_ELEM_DY);
+  auto elem_x = m.state(MAXPOOLING_ELEM_X); // 32
+  auto elem_y = m.state(MAXPOOLING_ELEM_Y);
+  auto elem_row_addr = m.state(MAXPOOLING_ELEM_ROW_ADDR);
 
-  auto cntr_find_max = child_loop.state(MAXPOOLING_FIND_MAX_CNTR);
   auto result = child_loop.state(MAXPOOLING_FIND_MAX_RESULT);
 
   // tensor memory state
@@ -254,52 +392,398 @@ void AddChild_Find_Max(Ila& m) {
   // instruction finding the max value in the pooling window
   {
     auto instr = child_find_max.NewInstr("maxpooling_find_max_op");
-    auto window_size = pool_y_16 * pool_x_16;
 
-    auto cntr_cond = (cntr_find_max < window_size);
     auto state_cond = (state == MAXPOOLING_STATE_FIND_MAX_CHILD);
 
-    instr.SetDecode(cntr_cond & state_cond);
+    instr.SetDecode(state_cond);
 
-    // base coordinates of the pooling window
-    auto win_x_base = out_x * Concat(BvConst(0, 24), stride_x);
-    auto win_y_base = out_y * Concat(BvConst(0, 24), stride_y);
+    // the padding wraps around to large unsigned values on the top/left side
+    auto in_bounds = (elem_x < width_in) & (elem_y < height_in);
 
-    // coordinates within the pooling window
-    auto win_x_offset = URem(cntr_find_max, pool_x_16);
-    auto win_y_offset = cntr_find_max / pool_x_16;
-
-    auto win_x_offset_32 = Concat(BvConst(0, 16), win_x_offset);
-    auto win_y_offset_32 = Concat(BvConst(0, 16), win_y_offset);
-
-    // coordinates in the 2D tensor
-    auto tensor_x = win_x_base + win_x_offset_32;
-    auto tensor_y = win_y_base + win_y_offset_32;
-
-    // calculate the memory address according to the tensor coordinates
-    auto addr = tensor_y * width_in + tensor_x;
-
-    // fetch the data in the memory
-    auto data = Load(tensor, addr);
+    // fetch the data in the memory, padding elements never win the max
+    auto data = Ite(in_bounds, Load(tensor, elem_row_addr + elem_x),
+                    BvConst(MAXPOOLING_PAD_VALUE,
+                            MAXPOOLING_FIND_MAX_RESULT_BITWIDTH));
 
     // auto result_tmp = Ite(cntr_find_max == 0, data,
     //                       Ite(data > result, data, result));
 
     // use uninterpreted function
-    auto result_tmp = Ite(cntr_find_max == 0, data, adpfloat_max(result, data));
+    auto first = (elem_dx == 0) & (elem_dy == 0);
+    auto result_tmp = Ite(first, data, adpfloat_max(result, data));
 
     // state updates
-    auto find_finish = (cntr_find_max == (window_size - 1));
+    auto find_finish = SetMaxpoolingNextElem(m, instr);
     auto next_state = Ite(
         find_finish, BvConst(MAXPOOLING_STATE_WRITE, MAXPOOLING_STATE_BITWIDTH),
         BvConst(MAXPOOLING_STATE_FIND_MAX_CHILD, MAXPOOLING_STATE_BITWIDTH));
 
-    instr.SetUpdate(cntr_find_max, cntr_find_max + 1);
     instr.SetUpdate(result, result_tmp);
     instr.SetUpdate(state, next_state);
   }
 }
 
+// point the window and the output row at output (0, 0) of a plane
+void SetMaxpoolingPlaneOrigin(Ila& m, InstrRef& instr, const ExprRef& in_base,
+                              const ExprRef& out_base, const ExprRef& width_in,
+                              const ExprRef& pad_y, const ExprRef& pad_x) {
+  auto win_x = BvConst(0, MAXPOOLING_WIN_X_BITWIDTH) - pad_x;
+  auto win_y = BvConst(0, MAXPOOLING_WIN_Y_BITWIDTH) - pad_y;
+  auto win_row_addr = in_base - pad_y * width_in;
+
+  instr.SetUpdate(m.state(MAXPOOLING_WIN_X), win_x);
+  instr.SetUpdate(m.state(MAXPOOLING_WIN_Y), win_y);
+  instr.SetUpdate(m.state(MAXPOOLING_WIN_ROW_ADDR), win_row_addr);
+  instr.SetUpdate(m.state(MAXPOOLING_OUT_ROW_ADDR), out_base);
+  SetMaxpoolingWindowStart(m, instr, win_x, win_y, win_row_addr);
+
+  // the separable row pass starts at the top row of the first window
+  instr.SetUpdate(m.state(MAXPOOLING_SEP_NEXT_ROW),
+                  BvConst(0, MAXPOOLING_SEP_NEXT_ROW_BITWIDTH));
+  instr.SetUpdate(m.state(MAXPOOLING_SEP_X),
+                  BvConst(0, MAXPOOLING_SEP_X_BITWIDTH));
+  instr.SetUpdate(m.state(MAXPOOLING_SEP_OFFSET),
+                  BvConst(0, MAXPOOLING_SEP_OFFSET_BITWIDTH));
+  instr.SetUpdate(m.state(MAXPOOLING_SEP_IN_X), win_x);
+  instr.SetUpdate(m.state(MAXPOOLING_SEP_ROW_ADDR), win_row_addr);
+  instr.SetUpdate(m.state(MAXPOOLING_SEP_RING_ADDR),
+                  BvConst(0, MAXPOOLING_SEP_RING_ADDR_BITWIDTH));
+  instr.SetUpdate(m.state(MAXPOOLING_SEP_COL_ADDR),
+                  BvConst(0, MAXPOOLING_SEP_COL_ADDR_BITWIDTH));
+}
+
+// start the element walk at the window origin (x, y)
+void SetMaxpoolingWindowStart(Ila& m, InstrRef& instr, const ExprRef& x,
+                              const ExprRef& y, const ExprRef& row_addr) {
+  instr.SetUpdate(m.state(MAXPOOLING_ELEM_DX),
+                  BvConst(0, MAXPOOLING_ELEM_DX_BITWIDTH));
+  instr.SetUpdate(m.state(MAXPOOLING_ELEM_DY),
+                  BvConst(0, MAXPOOLING_ELEM_DY_BITWIDTH));
+  instr.SetUpdate(m.state(MAXPOOLING_ELEM_X), x);
+  instr.SetUpdate(m.state(MAXPOOLING_ELEM_Y), y);
+  instr.SetUpdate(m.state(MAXPOOLING_ELEM_ROW_ADDR), row_addr);
+}
+
+// step to the next window element, row by row, with additions only. Returns
+// whether the current element is the last one of the window.
+ExprRef SetMaxpoolingNextElem(Ila& m, InstrRef& instr) {
+  auto pool_y = m.state(MAXPOOLING_POOL_Y);
+  auto pool_x = m.state(MAXPOOLING_POOL_X);
+  auto width_in = m.state(MAXPOOLING_DATA_IN_WIDTH);
+  auto win_x = m.state(MAXPOOLING_WIN_X);
+
+  auto elem_dx = m.state(MAXPOOLING_ELEM_DX);
+  auto elem_dy = m.state(MAXPOOLING_ELEM_DY);
+  auto elem_x = m.state(MAXPOOLING_ELEM_X);
+  auto elem_y = m.state(MAXPOOLING_ELEM_Y);
+  auto elem_row_addr = m.state(MAXPOOLING_ELEM_ROW_ADDR);
+
+  auto last_col = (elem_dx == (pool_x - 1));
+  auto last_row = (elem_dy == (pool_y - 1));
+
+  auto elem_dx_next =
+      Ite(last_col, BvConst(0, MAXPOOLING_ELEM_DX_BITWIDTH), elem_dx + 1);
+
+  instr.SetUpdate(elem_dx, elem_dx_next);
+  instr.SetUpdate(elem_dy, Ite(last_col, elem_dy + 1, elem_dy));
+  instr.SetUpdate(elem_x, Ite(last_col, win_x, elem_x + 1));
+  instr.SetUpdate(elem_y, Ite(last_col, elem_y + 1, elem_y));
+  instr.SetUpdate(elem_row_addr,
+                  Ite(last_col, elem_row_addr + width_in, elem_row_addr));
+
+  return last_col & last_row;
+}
+
+// separable mode: the maxima of the pool_x wide row segments of every input
+// row are computed once into a ring buffer of pool_y rows, each output is then
+// the max over pool_y buffered values. Overlapping windows (stride < pool)
+// share the row maxima instead of re-reading the tensor memory.
+// Like the direct mode, all addresses are kept in running states that only
+// step by additions: the window rows follow win_y/win_row_addr/out_row_addr,
+// the row pass keeps the address of its input row and segment and the ring
+// slot it writes, the column pass the ring slot it reads.
+void AddChild_Separable(Ila& m) {
+  auto child = m.child("maxpooling_loop_op");
+
+  auto flag_start = m.state(MAXPOOLING_START_FLAG);
+  auto state = m.state(MAXPOOLING_STATE);
+
+  auto cntr_Y = m.state(MAXPOOLING_Y_LOOP_CNTR);
+  auto height_out = m.state(MAXPOOLING_DATA_OUT_HEIGHT);
+  auto width_out = m.state(MAXPOOLING_DATA_OUT_WIDTH);
+
+  auto height_in = m.state(MAXPOOLING_DATA_IN_HEIGHT);
+  auto width_in = m.state(MAXPOOLING_DATA_IN_WIDTH);
+  auto out_row_stride = m.state(MAXPOOLING_OUT_ROW_STRIDE);
+
+  auto pool_y = Concat(BvConst(0, 24), m.state(MAXPOOLING_POOL_Y));
+  auto pool_x = Concat(BvConst(0, 24), m.state(MAXPOOLING_POOL_X));
+  auto stride_y = Concat(BvConst(0, 24), m.state(MAXPOOLING_STRIDE_Y));
+  auto stride_x = Concat(BvConst(0, 24), m.state(MAXPOOLING_STRIDE_X));
+  auto pad_y = Concat(BvConst(0, 24), m.state(MAXPOOLING_PAD_Y));
+  auto pad_x = Concat(BvConst(0, 24), m.state(MAXPOOLING_PAD_X));
+
+  auto win_y = m.state(MAXPOOLING_WIN_Y);
+  auto win_row_addr = m.state(MAXPOOLING_WIN_ROW_ADDR);
+  auto in_row_step = m.state(MAXPOOLING_IN_ROW_STEP);
+  auto out_row_addr = m.state(MAXPOOLING_OUT_ROW_ADDR);
+
+  auto tensor = m.state(RELAY_TENSOR_MEM);
+  auto result = child.state(MAXPOOLING_FIND_MAX_RESULT);
+
+  auto row_buf = child.NewMemState(MAXPOOLING_ROW_BUF,
+                                   MAXPOOLING_ROW_BUF_ADDR_BITWIDTH,
+                                   MAXPOOLING_ROW_BUF_DATA_BITWIDTH);
+  auto next_row = m.state(MAXPOOLING_SEP_NEXT_ROW);
+  auto sep_x = m.state(MAXPOOLING_SEP_X);
+  auto offset = m.state(MAXPOOLING_SEP_OFFSET);
+  auto in_x = m.state(MAXPOOLING_SEP_IN_X);
+  auto row_addr = m.state(MAXPOOLING_SEP_ROW_ADDR);
+  auto ring_addr = m.state(MAXPOOLING_SEP_RING_ADDR);
+  auto col_addr = m.state(MAXPOOLING_SEP_COL_ADDR);
+  auto ring_size = m.state(MAXPOOLING_SEP_RING_SIZE);
+
+  auto cond_flag = (flag_start == FLAG_ON);
+
+  // rows are counted in the padded plane, row r is input row r - pad_y
+  // input rows of the current output row are [row_begin, row_end)
+  auto row_begin = win_y + pad_y;
+  auto row_end = row_begin + pool_y;
+
+  auto last_offset_x = (offset == pool_x - 1);
+  auto last_offset_y = (offset == pool_y - 1);
+  auto last_x = (sep_x == width_out - 1);
+
+  // next ring slot (a row of width_out maxima), wrapping after pool_y slots
+  auto ring_next = [&](const ExprRef& slot_addr) -> ExprRef {
+    auto next = slot_addr + width_out;
+    return Ite(next == ring_size, BvConst(0, MAXPOOLING_SEP_RING_ADDR_BITWIDTH),
+               next);
+  };
+
+  // row pass -- max over one pool_x segment of input row next_row
+  {
+    auto instr = child.NewInstr("maxpooling_sep_row_op");
+
+    instr.SetDecode(cond_flag & (state == MAXPOOLING_STATE_SEP_ROW) &
+                    (next_row < row_end));
+
+    auto tensor_y = next_row - pad_y;
+    auto tensor_x = in_x + offset;
+    auto in_bounds = (tensor_x < width_in) & (tensor_y < height_in);
+
+    auto data = Ite(in_bounds, Load(tensor, row_addr + tensor_x),
+                    BvConst(MAXPOOLING_PAD_VALUE,
+                            MAXPOOLING_FIND_MAX_RESULT_BITWIDTH));
+    auto result_tmp = Ite(offset == 0, data, adpfloat_max(result, data));
+
+    auto buf_addr = ring_addr + sep_x;
+    auto row_done = last_offset_x & last_x;
+
+    instr.SetUpdate(result, result_tmp);
+    instr.SetUpdate(row_buf,
+                    Ite(last_offset_x, Store(row_buf, buf_addr, result_tmp),
+                        row_buf));
+    instr.SetUpdate(offset, Ite(last_offset_x, BvConst(0, 32), offset + 1));
+    instr.SetUpdate(
+        sep_x,
+        Ite(last_offset_x, Ite(last_x, BvConst(0, 32), sep_x + 1), sep_x));
+    instr.SetUpdate(
+        in_x, Ite(last_offset_x,
+                  Ite(last_x, BvConst(0, 32) - pad_x, in_x + stride_x), in_x));
+    instr.SetUpdate(next_row, Ite(row_done, next_row + 1, next_row));
+    instr.SetUpdate(row_addr, Ite(row_done, row_addr + width_in, row_addr));
+    instr.SetUpdate(ring_addr, Ite(row_done, ring_next(ring_addr), ring_addr));
+  }
+
+  // all rows of the window are buffered, start the column pass. The last
+  // pool_y rows written are the window, the oldest of them sits in the slot
+  // the row pass writes next.
+  {
+    auto instr = child.NewInstr("maxpooling_sep_col_start");
+
+    instr.SetDecode(cond_flag & (state == MAXPOOLING_STATE_SEP_ROW) &
+                    !(next_row < row_end));
+
+    instr.SetUpdate(sep_x, BvConst(0, MAXPOOLING_SEP_X_BITWIDTH));
+    instr.SetUpdate(offset, BvConst(0, MAXPOOLING_SEP_OFFSET_BITWIDTH));
+    instr.SetUpdate(col_addr, ring_addr);
+    instr.SetUpdate(
+        state, BvConst(MAXPOOLING_STATE_SEP_COL, MAXPOOLING_STATE_BITWIDTH));
+  }
+
+  // column pass -- max over the pool_y buffered row maxima of output sep_x
+  {
+    auto instr = child.NewInstr("maxpooling_sep_col_op");
+
+    instr.SetDecode(cond_flag & (state == MAXPOOLING_STATE_SEP_COL));
+
+    auto data = Load(row_buf, col_addr + sep_x);
+    auto result_tmp = Ite(offset == 0, data, adpfloat_max(result, data));
+
+    auto out_addr = out_row_addr + sep_x;
+
+    // move on to the next output row, skipping input rows that no window
+    // covers (stride_y > pool_y)
+    auto last_y = (cntr_Y == height_out - 1);
+    auto next_row_begin = row_begin + stride_y;
+    auto next_win_row_addr = win_row_addr + in_row_step;
+    auto row_done = last_offset_y & last_x;
+    auto skip = row_done & (next_row < next_row_begin);
+
+    auto next_state =
+        Ite(row_done,
+            Ite(last_y,
+                BvConst(MAXPOOLING_STATE_NEXT_PLANE, MAXPOOLING_STATE_BITWIDTH),
+                BvConst(MAXPOOLING_STATE_SEP_ROW, MAXPOOLING_STATE_BITWIDTH)),
+            state);
+
+    instr.SetUpdate(result, result_tmp);
+    instr.SetUpdate(
+        tensor,
+        Ite(last_offset_y, Store(tensor, out_addr, result_tmp), tensor));
+    instr.SetUpdate(offset, Ite(last_offset_y, BvConst(0, 32), offset + 1));
+    instr.SetUpdate(
+        sep_x,
+        Ite(last_offset_y, Ite(last_x, BvConst(0, 32), sep_x + 1), sep_x));
+    // back to the oldest window row for the next output column
+    instr.SetUpdate(col_addr,
+                    Ite(last_offset_y, ring_addr, ring_next(col_addr)));
+    instr.SetUpdate(cntr_Y, Ite(row_done, cntr_Y + 1, cntr_Y));
+    instr.SetUpdate(win_y, Ite(row_done, win_y + stride_y, win_y));
+    instr.SetUpdate(win_row_addr,
+                    Ite(row_done, next_win_row_addr, win_row_addr));
+    instr.SetUpdate(out_row_addr,
+                    Ite(row_done, out_row_addr + out_row_stride, out_row_addr));
+    instr.SetUpdate(next_row, Ite(skip, next_row_begin, next_row));
+    instr.SetUpdate(row_addr, Ite(skip, next_win_row_addr, row_addr));
+    instr.SetUpdate(state, next_state);
+  }
+}
+
+// lane mode: MAXPOOLING_LANES adjacent outputs of a row walk their windows
+// together, each step compares one window element of every lane with the
+// vector adpfloat_max_16. Lanes past width_out are computed but not written.
+void AddChild_Lanes(Ila& m) {
+  auto child = m.child("maxpooling_loop_op");
+
+  auto flag_start = m.state(MAXPOOLING_START_FLAG);
+  auto state = m.state(MAXPOOLING_STATE);
+
+  auto cntr_X = m.state(MAXPOOLING_X_LOOP_CNTR);
+  auto cntr_Y = m.state(MAXPOOLING_Y_LOOP_CNTR);
+  auto height_out = m.state(MAXPOOLING_DATA_OUT_HEIGHT);
+  auto width_out = m.state(MAXPOOLING_DATA_OUT_WIDTH);
+
+  auto height_in = m.state(MAXPOOLING_DATA_IN_HEIGHT);
+  auto width_in = m.state(MAXPOOLING_DATA_IN_WIDTH);
+  auto out_row_stride = m.state(MAXPOOLING_OUT_ROW_STRIDE);
+
+  auto stride_y = Concat(BvConst(0, 24), m.state(MAXPOOLING_STRIDE_Y));
+  auto stride_x = Concat(BvConst(0, 24), m.state(MAXPOOLING_STRIDE_X));
+  auto pad_x = Concat(BvConst(0, 24), m.state(MAXPOOLING_PAD_X));
+
+  auto win_x = m.state(MAXPOOLING_WIN_X);
+  auto win_y = m.state(MAXPOOLING_WIN_Y);
+  auto win_row_addr = m.state(MAXPOOLING_WIN_ROW_ADDR);
+  auto in_row_step = m.state(MAXPOOLING_IN_ROW_STEP);
+  auto out_row_addr = m.state(MAXPOOLING_OUT_ROW_ADDR);
+
+  auto elem_dx = m.state(MAXPOOLING_ELEM_DX);
+  auto elem_dy = m.state(MAXPOOLING_ELEM_DY);
+  auto elem_x = m.state(MAXPOOLING_ELEM_X);
+  auto elem_y = m.state(MAXPOOLING_ELEM_Y);
+  auto elem_row_addr = m.state(MAXPOOLING_ELEM_ROW_ADDR);
+
+  auto tensor = m.state(RELAY_TENSOR_MEM);
+  auto result = child.NewBvState(MAXPOOLING_LANE_RESULT,
+                                 MAXPOOLING_LANE_RESULT_BITWIDTH);
+
+  auto cond_flag = (flag_start == FLAG_ON);
+
+  // compare one window element of all the lanes, lane 0 is at elem_x and the
+  // others follow stride_x apart
+  {
+    auto instr = child.NewInstr("maxpooling_lane_max_op");
+
+    instr.SetDecode(cond_flag & (state == MAXPOOLING_STATE_LANE_MAX));
+
+    auto row_in_bounds = (elem_y < height_in);
+
+    std::vector<ExprRef> lanes;
+    auto lane_x = elem_x;
+    for (auto i = 0; i < MAXPOOLING_LANES; i++) {
+      auto in_bounds = row_in_bounds & (lane_x < width_in);
+      auto data = Ite(in_bounds, Load(tensor, elem_row_addr + lane_x),
+                      BvConst(MAXPOOLING_PAD_VALUE,
+                              MAXPOOLING_FIND_MAX_RESULT_BITWIDTH));
+      lanes.push_back(data);
+      lane_x = lane_x + stride_x;
+    }
+    // lane 0 in the lowest bits
+    auto line = lanes[0];
+    for (auto i = 1; i < MAXPOOLING_LANES; i++) {
+      line = Concat(lanes[i], line);
+    }
+
+    auto first = (elem_dx == 0) & (elem_dy == 0);
+    auto result_tmp = Ite(first, line, adpfloat_max_16(result, line));
+
+    auto find_finish = SetMaxpoolingNextElem(m, instr);
+    auto next_state = Ite(
+        find_finish,
+        BvConst(MAXPOOLING_STATE_LANE_WRITE, MAXPOOLING_STATE_BITWIDTH),
+        BvConst(MAXPOOLING_STATE_LANE_MAX, MAXPOOLING_STATE_BITWIDTH));
+
+    instr.SetUpdate(result, result_tmp);
+    instr.SetUpdate(state, next_state);
+  }
+
+  // write the lanes back and move on to the next MAXPOOLING_LANES outputs
+  {
+    auto instr = child.NewInstr("maxpooling_lane_write");
+
+    instr.SetDecode(cond_flag & (state == MAXPOOLING_STATE_LANE_WRITE));
+
+    auto tensor_next = tensor;
+    for (auto i = 0; i < MAXPOOLING_LANES; i++) {
+      auto lane = Extract(result, 8 * i + 7, 8 * i);
+      auto valid = ((cntr_X + i) < width_out);
+      tensor_next = Ite(
+          valid, Store(tensor_next, out_row_addr + cntr_X + i, lane),
+          tensor_next);
+    }
+
+    auto last_x = !((cntr_X + MAXPOOLING_LANES) < width_out);
+    auto last_y = (cntr_Y == (height_out - 1));
+
+    auto next_state = Ite(
+        last_x & last_y,
+        BvConst(MAXPOOLING_STATE_NEXT_PLANE, MAXPOOLING_STATE_BITWIDTH),
+        BvConst(MAXPOOLING_STATE_LANE_MAX, MAXPOOLING_STATE_BITWIDTH));
+
+    // window origin of the next lane group
+    auto win_x_next = Ite(last_x, BvConst(0, 32) - pad_x,
+                          win_x + stride_x * MAXPOOLING_LANES);
+    auto win_y_next = Ite(last_x, win_y + stride_y, win_y);
+    auto win_row_addr_next =
+        Ite(last_x, win_row_addr + in_row_step, win_row_addr);
+
+    instr.SetUpdate(tensor, tensor_next);
+    instr.SetUpdate(cntr_X,
+                    Ite(last_x, BvConst(0, 32), cntr_X + MAXPOOLING_LANES));
+    instr.SetUpdate(cntr_Y, Ite(last_x, cntr_Y + 1, cntr_Y));
+    instr.SetUpdate(win_x, win_x_next);
+    instr.SetUpdate(win_y, win_y_next);
+    instr.SetUpdate(win_row_addr, win_row_addr_next);
+    instr.SetUpdate(out_row_addr,
+                    Ite(last_x, out_row_addr + out_row_stride, out_row_addr));
+    SetMaxpoolingWindowStart(m, instr, win_x_next, win_y_next,
+                             win_row_addr_next);
+    instr.SetUpdate(state, next_state);
+  }
+}
+
 } // namespace relay
 
 } // namespace ilang
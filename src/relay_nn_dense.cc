@@ -24,6 +24,9 @@
 
 // File: relay_nn_dense.cc
 
+#include <string>
+#include <vector>
+
 #include <ilang/util/log.h>
 
 #include <relay/relay_top.h>
@@ -33,6 +36,8 @@ namespace ilang {
 
 namespace relay {
 
+void SetNNDenseNextRow(Ila& m, InstrRef& instr);
+
 void DefineNNDense(Ila& m) {
   auto nn_child = m.child(RELAY_NN_CHILD);
 
@@ -43,6 +48,14 @@ void DefineNNDense(Ila& m) {
   auto output_size = m.state(RELAY_NN_OUTPUT_SIZE);
   auto input_wrap_around = m.state(RELAY_NN_INPUT_WRAP_AROUND);
 
+  auto batch_size = m.state(RELAY_NN_BATCH_SIZE);
+  auto input_batch_stride = m.state(RELAY_NN_INPUT_BATCH_STRIDE);
+  auto output_batch_stride = m.state(RELAY_NN_OUTPUT_BATCH_STRIDE);
+
+  auto accumulate = (m.state(RELAY_NN_ACCUMULATE) == RELAY_FLAG_ON);
+  auto skip_bias = (m.state(RELAY_NN_SKIP_BIAS) == RELAY_FLAG_ON);
+  auto block_size = m.state(RELAY_NN_BLOCK_SIZE);
+
   auto weight_addr = m.state(RELAY_NN_WEIGHT_ADDR);
   auto bias_addr = m.state(RELAY_NN_BIAS_ADDR);
   auto input_addr = m.state(RELAY_NN_INPUT_ADDR);
@@ -50,20 +63,27 @@ void DefineNNDense(Ila& m) {
 
   auto state = m.state(RELAY_NN_DENSE_STATE);
 
-  auto return_state = m.state(RELAY_LSTM_RETURN_STATE);
-
   auto memory = m.state(RELAY_MEMORY);
 
+  // matrix-matrix mode, each weight word is applied to a group of batch
+  // columns at once
+  auto batched = (batch_size != BvConst(1, RELAY_NN_SIZE_BW));
+  // register-blocked matrix-vector mode, block_size rows share the input loads
+  auto blocked = !batched & !(block_size < BvConst(2, RELAY_NN_SIZE_BW));
+
   instr.SetDecode(
       (dense_enable == BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW)) &
       (input_size != BvConst(0, RELAY_NN_SIZE_BW)) &
       (output_size != BvConst(0, RELAY_NN_SIZE_BW)) &
+      (batch_size != BvConst(0, RELAY_NN_SIZE_BW)) &
       (state == BvConst(RELAY_NN_DENSE_IDLE_STATE, RELAY_NN_DENSE_STATE_BW)));
 
   auto loop_cntr = m.state(RELAY_NN_DENSE_LOOP_CNTR);
   auto loop_start = m.state(RELAY_NN_DENSE_LOOP_START);
+  auto batch_index = m.state(RELAY_NN_DENSE_BATCH_INDEX);
 
   instr.SetUpdate(loop_cntr, BvConst(0, RELAY_NN_SIZE_BW));
+  instr.SetUpdate(batch_index, BvConst(0, RELAY_NN_SIZE_BW));
   instr.SetUpdate(loop_start, BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
   instr.SetUpdate(
       state, BvConst(RELAY_NN_DENSE_LOOP_INIT_STATE, RELAY_NN_DENSE_STATE_BW));
@@ -79,6 +99,16 @@ void DefineNNDense(Ila& m) {
     auto input_index =
         loop_child.NewBvState(RELAY_NN_DENSE_INPUT_INDEX, RELAY_NN_SIZE_BW);
     auto acc = loop_child.NewBvState(RELAY_NN_DENSE_ACC, RELAY_NN_SIZE_BW);
+    auto block_rows =
+        loop_child.NewBvState(RELAY_NN_DENSE_BLOCK_ROWS, RELAY_NN_SIZE_BW);
+    auto block_cntr =
+        loop_child.NewBvState(RELAY_NN_DENSE_BLOCK_CNTR, RELAY_NN_SIZE_BW);
+
+    std::vector<ExprRef> block_acc = {acc};
+    for (auto r = 1; r < RELAY_NN_DENSE_MAX_BLOCK; r++) {
+      block_acc.push_back(loop_child.NewBvState(
+          RELAY_NN_DENSE_BLOCK_ACC + std::to_string(r), RELAY_VECTOR_DATA_BW));
+    }
 
     {
       auto init_instr = loop_child.NewInstr(RELAY_NN_DENSE_LOOP_INIT_INSTR);
@@ -89,16 +119,83 @@ void DefineNNDense(Ila& m) {
       init_instr.SetUpdate(input_index, BvConst(0, RELAY_NN_SIZE_BW));
       init_instr.SetUpdate(state, BvConst(RELAY_NN_DENSE_LOOP_FMA_STATE,
                                           RELAY_NN_DENSE_STATE_BW));
+      for (auto& block_row_acc : block_acc) {
+        init_instr.SetUpdate(
+            block_row_acc,
+            BvConst(RELAY_VECTOR_DATA_ZERO, RELAY_VECTOR_DATA_BW));
+      }
+
+      // the last block may be cut short by the output size, the last group
+      // of batch columns by the batch size
+      auto rows_left = output_size - loop_cntr;
+      auto rows = Ite(blocked, block_size, BvConst(1, RELAY_NN_SIZE_BW));
+      auto cols_left = batch_size - batch_index;
+      auto max_cols = BvConst(RELAY_NN_DENSE_MAX_BLOCK, RELAY_NN_SIZE_BW);
       init_instr.SetUpdate(
-          acc, BvConst(RELAY_VECTOR_DATA_ZERO, RELAY_VECTOR_DATA_BW));
+          block_rows,
+          Ite(batched, Ite(cols_left < max_cols, cols_left, max_cols),
+              Ite(rows_left < rows, rows_left, rows)));
+      init_instr.SetUpdate(block_cntr, BvConst(0, RELAY_NN_SIZE_BW));
 
       {
         auto fma_child = loop_child.NewChild(RELAY_NN_DENSE_FMA_CHILD);
         fma_child.SetValid(state == RELAY_NN_DENSE_LOOP_FMA_STATE);
+
+        // a single row, either unblocked or the short last block
+        auto single_row = (block_rows == BvConst(1, RELAY_NN_SIZE_BW));
+        // a whole tile of the row is left and the input is read linearly
+        auto dot_fits =
+            (input_wrap_around == BvConst(0, RELAY_NN_SIZE_BW)) &
+            !((input_size - fma_cntr) <
+              BvConst(RELAY_NN_DENSE_DOT_TILE, RELAY_NN_SIZE_BW));
+        {
+          auto dot_instr = fma_child.NewInstr(RELAY_NN_DENSE_LOOP_DOT_INSTR);
+
+          dot_instr.SetDecode((state == RELAY_NN_DENSE_LOOP_FMA_STATE) &
+                              !batched & single_row & dot_fits);
+
+          auto load_weight_addr =
+              weight_addr +
+              (loop_cntr * input_size + fma_cntr) * RELAY_VECTOR_DATA_BYTES;
+          auto load_input_addr =
+              input_addr + input_index * RELAY_VECTOR_DATA_BYTES;
+
+          // pack the tiles, element k lives in bits [32k+31:32k]
+          auto weight_tile = RELAY_LOAD_WORD(memory, load_weight_addr);
+          auto input_tile = RELAY_LOAD_WORD(memory, load_input_addr);
+          for (auto k = 1; k < RELAY_NN_DENSE_DOT_TILE; k++) {
+            auto offset = k * RELAY_VECTOR_DATA_BYTES;
+            weight_tile =
+                Concat(RELAY_LOAD_WORD(memory, load_weight_addr + offset),
+                       weight_tile);
+            input_tile = Concat(
+                RELAY_LOAD_WORD(memory, load_input_addr + offset), input_tile);
+          }
+
+          auto next_acc = bv_add(acc, bv_dot_product(weight_tile, input_tile));
+
+          auto next_fma_cntr =
+              fma_cntr + BvConst(RELAY_NN_DENSE_DOT_TILE, RELAY_NN_SIZE_BW);
+          auto fma_continue = (next_fma_cntr != input_size);
+
+          auto next_state = Ite(fma_continue, state,
+                                BvConst(RELAY_NN_DENSE_LOOP_WRITE_STATE,
+                                        RELAY_NN_DENSE_STATE_BW));
+
+          dot_instr.SetUpdate(state, next_state);
+          dot_instr.SetUpdate(acc, next_acc);
+          dot_instr.SetUpdate(
+              input_index,
+              input_index +
+                  BvConst(RELAY_NN_DENSE_DOT_TILE, RELAY_NN_SIZE_BW));
+          dot_instr.SetUpdate(fma_cntr, next_fma_cntr);
+        }
         {
           auto fma_instr = fma_child.NewInstr(RELAY_NN_DENSE_LOOP_FMA_INSTR);
 
-          fma_instr.SetDecode(state == RELAY_NN_DENSE_LOOP_FMA_STATE);
+          // scalar path for the row tail (and wrapped-around inputs)
+          fma_instr.SetDecode((state == RELAY_NN_DENSE_LOOP_FMA_STATE) &
+                              !batched & single_row & !dot_fits);
 
           auto load_weight_addr =
               weight_addr +
@@ -113,9 +210,9 @@ void DefineNNDense(Ila& m) {
           auto load_input_addr =
               input_addr + input_index * RELAY_VECTOR_DATA_BYTES;
 
-          auto next_acc = bv_add(
-              acc, bv_multiply(RELAY_LOAD_WORD(memory, load_weight_addr),
-                               RELAY_LOAD_WORD(memory, load_input_addr)));
+          auto next_acc =
+              bv_fma({RELAY_LOAD_WORD(memory, load_weight_addr),
+                      RELAY_LOAD_WORD(memory, load_input_addr), acc});
 
           auto next_fma_cntr = fma_cntr + BvConst(1, RELAY_NN_SIZE_BW);
           auto fma_continue = (next_fma_cntr != input_size);
@@ -129,43 +226,314 @@ void DefineNNDense(Ila& m) {
           fma_instr.SetUpdate(input_index, next_input_index);
           fma_instr.SetUpdate(fma_cntr, next_fma_cntr);
         }
+        // blocked: one input load (a tile in the dot step, an element in the
+        // FMA step) is shared by all rows of the block. One instruction per
+        // block size, so each step only loads the weights of its own rows.
+        for (auto n = 2; n <= RELAY_NN_DENSE_MAX_BLOCK; n++) {
+          auto rows_match = (block_rows == BvConst(n, RELAY_NN_SIZE_BW));
+          {
+            auto block_dot_instr = fma_child.NewInstr(
+                RELAY_NN_DENSE_LOOP_BLOCK_DOT_INSTR + std::to_string(n));
+
+            block_dot_instr.SetDecode((state == RELAY_NN_DENSE_LOOP_FMA_STATE) &
+                                      !batched & rows_match & dot_fits);
+
+            auto load_input_addr =
+                input_addr + input_index * RELAY_VECTOR_DATA_BYTES;
+            auto input_tile = RELAY_LOAD_WORD(memory, load_input_addr);
+            for (auto k = 1; k < RELAY_NN_DENSE_DOT_TILE; k++) {
+              input_tile = Concat(
+                  RELAY_LOAD_WORD(memory, load_input_addr +
+                                              k * RELAY_VECTOR_DATA_BYTES),
+                  input_tile);
+            }
+
+            for (auto r = 0; r < n; r++) {
+              auto row = loop_cntr + BvConst(r, RELAY_NN_SIZE_BW);
+              auto load_weight_addr =
+                  weight_addr +
+                  (row * input_size + fma_cntr) * RELAY_VECTOR_DATA_BYTES;
+
+              auto weight_tile = RELAY_LOAD_WORD(memory, load_weight_addr);
+              for (auto k = 1; k < RELAY_NN_DENSE_DOT_TILE; k++) {
+                weight_tile = Concat(
+                    RELAY_LOAD_WORD(memory, load_weight_addr +
+                                                k * RELAY_VECTOR_DATA_BYTES),
+                    weight_tile);
+              }
+
+              auto next_acc = bv_add(
+                  block_acc[r], bv_dot_product(weight_tile, input_tile));
+              block_dot_instr.SetUpdate(block_acc[r], next_acc);
+            }
+
+            auto next_fma_cntr =
+                fma_cntr + BvConst(RELAY_NN_DENSE_DOT_TILE, RELAY_NN_SIZE_BW);
+            auto fma_continue = (next_fma_cntr != input_size);
+
+            auto next_state = Ite(fma_continue, state,
+                                  BvConst(RELAY_NN_DENSE_LOOP_WRITE_STATE,
+                                          RELAY_NN_DENSE_STATE_BW));
+
+            block_dot_instr.SetUpdate(state, next_state);
+            block_dot_instr.SetUpdate(
+                input_index,
+                input_index +
+                    BvConst(RELAY_NN_DENSE_DOT_TILE, RELAY_NN_SIZE_BW));
+            block_dot_instr.SetUpdate(fma_cntr, next_fma_cntr);
+          }
+          {
+            auto block_fma_instr = fma_child.NewInstr(
+                RELAY_NN_DENSE_LOOP_BLOCK_FMA_INSTR + std::to_string(n));
+
+            block_fma_instr.SetDecode((state == RELAY_NN_DENSE_LOOP_FMA_STATE) &
+                                      !batched & rows_match & !dot_fits);
+
+            auto input_index_plus1 =
+                input_index + BvConst(1, RELAY_NN_SIZE_BW);
+            auto next_input_index =
+                Ite((input_wrap_around != BvConst(0, RELAY_NN_SIZE_BW)) &
+                        (input_index_plus1 != input_wrap_around),
+                    BvConst(0, RELAY_NN_SIZE_BW), input_index_plus1);
+
+            auto input = RELAY_LOAD_WORD(
+                memory, input_addr + input_index * RELAY_VECTOR_DATA_BYTES);
+
+            for (auto r = 0; r < n; r++) {
+              auto row = loop_cntr + BvConst(r, RELAY_NN_SIZE_BW);
+              auto load_weight_addr =
+                  weight_addr +
+                  (row * input_size + fma_cntr) * RELAY_VECTOR_DATA_BYTES;
+
+              auto weight_word = RELAY_LOAD_WORD(memory, load_weight_addr);
+              block_fma_instr.SetUpdate(
+                  block_acc[r], bv_fma({weight_word, input, block_acc[r]}));
+            }
+
+            auto next_fma_cntr = fma_cntr + BvConst(1, RELAY_NN_SIZE_BW);
+            auto fma_continue = (next_fma_cntr != input_size);
+
+            auto next_state = Ite(fma_continue, state,
+                                  BvConst(RELAY_NN_DENSE_LOOP_WRITE_STATE,
+                                          RELAY_NN_DENSE_STATE_BW));
+
+            block_fma_instr.SetUpdate(state, next_state);
+            block_fma_instr.SetUpdate(input_index, next_input_index);
+            block_fma_instr.SetUpdate(fma_cntr, next_fma_cntr);
+          }
+        }
+        // batched: W[row][fma_cntr] is loaded once and applied to a group of
+        // up to RELAY_NN_DENSE_MAX_BLOCK batch columns, column batch_index + c
+        // accumulates in block accumulator c. One instruction per group size,
+        // so each step only loads the inputs of its own columns.
+        for (auto n = 1; n <= RELAY_NN_DENSE_MAX_BLOCK; n++) {
+          auto batch_instr = fma_child.NewInstr(
+              RELAY_NN_DENSE_LOOP_BATCH_INSTR + std::to_string(n));
+          batch_instr.SetDecode((state == RELAY_NN_DENSE_LOOP_FMA_STATE) &
+                                batched &
+                                (block_rows == BvConst(n, RELAY_NN_SIZE_BW)));
+
+          auto load_weight_addr =
+              weight_addr +
+              (loop_cntr * input_size + fma_cntr) * RELAY_VECTOR_DATA_BYTES;
+          auto weight_word = RELAY_LOAD_WORD(memory, load_weight_addr);
+
+          for (auto c = 0; c < n; c++) {
+            auto load_input_addr =
+                input_addr +
+                (batch_index + BvConst(c, RELAY_NN_SIZE_BW)) *
+                    input_batch_stride +
+                fma_cntr * RELAY_VECTOR_DATA_BYTES;
+            batch_instr.SetUpdate(
+                block_acc[c],
+                bv_fma({weight_word, RELAY_LOAD_WORD(memory, load_input_addr),
+                        block_acc[c]}));
+          }
+
+          auto next_fma_cntr = fma_cntr + BvConst(1, RELAY_NN_SIZE_BW);
+          auto fma_continue = (next_fma_cntr != input_size);
+
+          auto next_state = Ite(fma_continue, state,
+                                BvConst(RELAY_NN_DENSE_LOOP_WRITE_STATE,
+                                        RELAY_NN_DENSE_STATE_BW));
+
+          batch_instr.SetUpdate(state, next_state);
+          batch_instr.SetUpdate(fma_cntr, next_fma_cntr);
+        }
       }
     }
 
     {
-      auto write_instr = loop_child.NewInstr(RELAY_NN_DENSE_LOOP_WRITE_INSTR);
-      write_instr.SetDecode(state == BvConst(RELAY_NN_DENSE_LOOP_WRITE_STATE,
-                                             RELAY_NN_DENSE_STATE_BW));
+      // the rows of a block (or the columns of a batch group) are written one
+      // per step, accumulator block_cntr goes to row loop_cntr of column
+      // batch_index + block_cntr
+      auto row_acc = block_acc[RELAY_NN_DENSE_MAX_BLOCK - 1];
+      for (auto r = RELAY_NN_DENSE_MAX_BLOCK - 2; r >= 0; r--) {
+        row_acc = Ite(block_cntr == BvConst(r, RELAY_NN_SIZE_BW), block_acc[r],
+                      row_acc);
+      }
 
-      auto next_loop_cntr = loop_cntr + BvConst(1, RELAY_NN_SIZE_BW);
-      auto loop_continue = (next_loop_cntr != output_size);
       auto addr_offset = loop_cntr * RELAY_VECTOR_DATA_BYTES;
-      auto result =
-          bv_add(acc, RELAY_LOAD_WORD(memory, bias_addr + addr_offset));
-
-      auto next_state =
-          Ite(loop_continue,
-              BvConst(RELAY_NN_DENSE_LOOP_INIT_STATE, RELAY_NN_DENSE_STATE_BW),
-              BvConst(RELAY_NN_DENSE_IDLE_STATE, RELAY_NN_DENSE_STATE_BW));
-
-      auto next_dense_enable = RELAY_ITE_FLAG(loop_continue);
-      auto next_loop_start = RELAY_ITE_FLAG(loop_continue);
-
-      auto lstm_state = m.state(RELAY_LSTM_STATE);
-      auto next_lstm_state =
-          Ite(loop_continue, lstm_state, m.state(RELAY_LSTM_RETURN_STATE));
-
-      write_instr.SetUpdate(state, next_state);
-      write_instr.SetUpdate(dense_enable, next_dense_enable);
-      write_instr.SetUpdate(loop_start, next_loop_start);
-      write_instr.SetUpdate(lstm_state, next_lstm_state);
-      write_instr.SetUpdate(loop_cntr, next_loop_cntr);
-      write_instr.SetUpdate(
-          memory, RELAY_STORE_WORD(memory, output_addr + addr_offset, result));
+      auto out_addr =
+          output_addr + addr_offset +
+          Ite(batched, (batch_index + block_cntr) * output_batch_stride,
+              BvConst(0, RELAY_NN_ADDR_BW));
+      auto biased = Ite(
+          skip_bias, row_acc,
+          bv_add(row_acc, RELAY_LOAD_WORD(memory, bias_addr + addr_offset)));
+      auto prev_output = RELAY_LOAD_WORD(memory, out_addr);
+      auto result = Ite(accumulate, bv_add(prev_output, biased), biased);
+      auto next_memory = RELAY_STORE_WORD(memory, out_addr, result);
+
+      auto next_block_cntr = block_cntr + BvConst(1, RELAY_NN_SIZE_BW);
+      auto block_continue = (next_block_cntr != block_rows);
+
+      auto write_state = (state == BvConst(RELAY_NN_DENSE_LOOP_WRITE_STATE,
+                                           RELAY_NN_DENSE_STATE_BW));
+      auto next_batch_index = batch_index + block_rows;
+      auto last_group = (next_batch_index == batch_size);
+
+      {
+        auto write_instr = loop_child.NewInstr(RELAY_NN_DENSE_LOOP_WRITE_INSTR);
+        write_instr.SetDecode(write_state & !block_continue &
+                              (!batched | last_group));
+
+        SetNNDenseNextRow(m, write_instr);
+        write_instr.SetUpdate(memory, next_memory);
+      }
+      {
+        auto block_write_instr =
+            loop_child.NewInstr(RELAY_NN_DENSE_LOOP_BLOCK_WRITE_INSTR);
+        block_write_instr.SetDecode(write_state & block_continue);
+
+        block_write_instr.SetUpdate(memory, next_memory);
+        block_write_instr.SetUpdate(
+            loop_cntr,
+            Ite(batched, loop_cntr, loop_cntr + BvConst(1, RELAY_NN_SIZE_BW)));
+        block_write_instr.SetUpdate(block_cntr, next_block_cntr);
+      }
+      {
+        // same row, next group of batch columns
+        auto next_group_instr =
+            loop_child.NewInstr(RELAY_NN_DENSE_LOOP_NEXT_GROUP_INSTR);
+        next_group_instr.SetDecode(write_state & !block_continue & batched &
+                                   !last_group);
+
+        next_group_instr.SetUpdate(memory, next_memory);
+        next_group_instr.SetUpdate(batch_index, next_batch_index);
+        next_group_instr.SetUpdate(
+            state,
+            BvConst(RELAY_NN_DENSE_LOOP_INIT_STATE, RELAY_NN_DENSE_STATE_BW));
+      }
     }
   }
 }
 
+void SetNNDenseNextRow(Ila& m, InstrRef& instr) {
+  auto state = m.state(RELAY_NN_DENSE_STATE);
+  auto dense_enable = m.state(RELAY_NN_DENSE_ENABLE);
+  auto loop_cntr = m.state(RELAY_NN_DENSE_LOOP_CNTR);
+  auto loop_start = m.state(RELAY_NN_DENSE_LOOP_START);
+  auto batch_index = m.state(RELAY_NN_DENSE_BATCH_INDEX);
+
+  auto next_loop_cntr = loop_cntr + BvConst(1, RELAY_NN_SIZE_BW);
+  auto loop_continue = (next_loop_cntr != m.state(RELAY_NN_OUTPUT_SIZE));
+
+  auto next_state =
+      Ite(loop_continue,
+          BvConst(RELAY_NN_DENSE_LOOP_INIT_STATE, RELAY_NN_DENSE_STATE_BW),
+          BvConst(RELAY_NN_DENSE_IDLE_STATE, RELAY_NN_DENSE_STATE_BW));
+
+  auto next_dense_enable = RELAY_ITE_FLAG(loop_continue);
+  auto next_loop_start = RELAY_ITE_FLAG(loop_continue);
+
+  auto lstm_state = m.state(RELAY_LSTM_STATE);
+  auto next_lstm_state =
+      Ite(loop_continue, lstm_state, m.state(RELAY_LSTM_RETURN_STATE));
+
+  // a direct call (nothing to return to) is done after the last row
+  auto func_done = m.state(RELAY_FUNC_DONE);
+  auto return_wait = (m.state(RELAY_LSTM_RETURN_STATE) ==
+                      BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
+  auto next_func_done =
+      Ite(!loop_continue & return_wait,
+          BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH), func_done);
+
+  instr.SetUpdate(state, next_state);
+  instr.SetUpdate(dense_enable, next_dense_enable);
+  instr.SetUpdate(loop_start, next_loop_start);
+  instr.SetUpdate(lstm_state, next_lstm_state);
+  instr.SetUpdate(loop_cntr, next_loop_cntr);
+  instr.SetUpdate(batch_index, BvConst(0, RELAY_NN_SIZE_BW));
+  instr.SetUpdate(func_done, next_func_done);
+}
+
+void DefineNNDenseFunc(Ila& m) {
+  auto instr = m.NewInstr(F_NN_DENSE);
+
+  auto func_id_match = (m.input(RELAY_FUNC_ID_IN) == F_NN_DENSE_ID);
+  auto func_run = (m.input(RELAY_FUNC_RUN_IN) == RELAY_FUNC_RUN_ON);
+
+  instr.SetDecode(func_id_match & func_run);
+
+  // function arguments, batch size 0 is treated as a single column
+  auto batch = m.input(RELAY_NN_DENSE_BATCH);
+  auto batch_size =
+      Ite(batch == BvConst(0, RELAY_NN_SIZE_BW), BvConst(1, RELAY_NN_SIZE_BW),
+          batch);
+  // blocks larger than the accumulator file are clamped
+  auto block = m.input(RELAY_NN_DENSE_BLOCK);
+  auto max_block = BvConst(RELAY_NN_DENSE_MAX_BLOCK, RELAY_NN_SIZE_BW);
+  auto block_size = Ite(max_block < block, max_block, block);
+
+  instr.SetUpdate(m.state(RELAY_NN_DENSE_ENABLE),
+                  BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
+  instr.SetUpdate(
+      m.state(RELAY_NN_DENSE_STATE),
+      BvConst(RELAY_NN_DENSE_IDLE_STATE, RELAY_NN_DENSE_STATE_BW));
+
+  instr.SetUpdate(m.state(RELAY_NN_INPUT_SIZE),
+                  m.input(RELAY_NN_DENSE_IN_SIZE));
+  instr.SetUpdate(m.state(RELAY_NN_OUTPUT_SIZE),
+                  m.input(RELAY_NN_DENSE_OUT_SIZE));
+  instr.SetUpdate(m.state(RELAY_NN_INPUT_WRAP_AROUND),
+                  BvConst(0, RELAY_NN_SIZE_BW));
+
+  instr.SetUpdate(m.state(RELAY_NN_BATCH_SIZE), batch_size);
+  instr.SetUpdate(m.state(RELAY_NN_INPUT_BATCH_STRIDE),
+                  m.input(RELAY_NN_DENSE_INPUT_STRIDE));
+  instr.SetUpdate(m.state(RELAY_NN_OUTPUT_BATCH_STRIDE),
+                  m.input(RELAY_NN_DENSE_OUTPUT_STRIDE));
+
+  instr.SetUpdate(m.state(RELAY_NN_ACCUMULATE),
+                  m.input(RELAY_NN_DENSE_ACCUMULATE));
+  instr.SetUpdate(m.state(RELAY_NN_SKIP_BIAS),
+                  m.input(RELAY_NN_DENSE_SKIP_BIAS));
+  instr.SetUpdate(m.state(RELAY_NN_BLOCK_SIZE), block_size);
+
+  instr.SetUpdate(m.state(RELAY_NN_WEIGHT_ADDR),
+                  m.input(RELAY_NN_DENSE_WEIGHT_ADDR));
+  instr.SetUpdate(m.state(RELAY_NN_BIAS_ADDR),
+                  m.input(RELAY_NN_DENSE_BIAS_ADDR));
+  instr.SetUpdate(m.state(RELAY_NN_INPUT_ADDR),
+                  m.input(RELAY_NN_DENSE_INPUT_ADDR));
+  instr.SetUpdate(m.state(RELAY_NN_OUTPUT_ADDR),
+                  m.input(RELAY_NN_DENSE_OUTPUT_ADDR));
+
+  // nothing to return to once the last row is written
+  instr.SetUpdate(m.state(RELAY_LSTM_RETURN_STATE),
+                  BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
+
+  // an empty matrix never starts the child, so it is done at once
+  auto empty = (m.input(RELAY_NN_DENSE_IN_SIZE) ==
+                BvConst(0, RELAY_NN_SIZE_BW)) |
+               (m.input(RELAY_NN_DENSE_OUT_SIZE) ==
+                BvConst(0, RELAY_NN_SIZE_BW));
+  auto done_on = BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH);
+  auto done_off = BvConst(RELAY_FUNC_DONE_OFF, RELAY_FUNC_DONE_BITWIDTH);
+  instr.SetUpdate(m.state(RELAY_FUNC_DONE), Ite(empty, done_on, done_off));
+}
+
 } // namespace relay
 
 } // namespace ilang
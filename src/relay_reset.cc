@@ -0,0 +1,79 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2020 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: relay_reset.cc
+
+// return the control states of all functions to idle: the start/enable flags,
+// the state machines, relay_data_out and the done flag. Operands and memories are left alone,
+// every function call sets its own operands.
+
+#include <ilang/util/log.h>
+
+#include <relay/relay_top.h>
+
+namespace ilang {
+
+namespace relay {
+
+void DefineReset(Ila& m) {
+  auto instr = m.NewInstr(F_RESET);
+
+  auto func_run = (m.input(RELAY_FUNC_RUN_IN) == RELAY_FUNC_RUN_ON);
+  auto func_id_match = (m.input(RELAY_FUNC_ID_IN) == F_RESET_ID);
+
+  instr.SetDecode(func_run & func_id_match);
+
+  // maxpooling 2d
+  instr.SetUpdate(m.state(MAXPOOLING_START_FLAG),
+                  BvConst(FLAG_OFF, MAXPOOLING_START_FLAG_BITWIDTH));
+  instr.SetUpdate(m.state(MAXPOOLING_STATE),
+                  BvConst(MAXPOOLING_STATE_DONE, MAXPOOLING_STATE_BITWIDTH));
+
+  // lstm
+  instr.SetUpdate(m.state(RELAY_LSTM_START),
+                  BvConst(RELAY_LSTM_FLAG_OFF, RELAY_LSTM_FLAG_BW));
+  auto lstm_wait = BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW);
+  instr.SetUpdate(m.state(RELAY_LSTM_STATE), lstm_wait);
+  instr.SetUpdate(m.state(RELAY_LSTM_RETURN_STATE), lstm_wait);
+
+  // vector op
+  auto flag_off = BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW);
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP_ENABLE), flag_off);
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP_START), flag_off);
+
+  // nn dense
+  instr.SetUpdate(m.state(RELAY_NN_DENSE_ENABLE), flag_off);
+  instr.SetUpdate(m.state(RELAY_NN_DENSE_LOOP_START), flag_off);
+  instr.SetUpdate(m.state(RELAY_NN_DENSE_STATE),
+                  BvConst(RELAY_NN_DENSE_IDLE_STATE, RELAY_NN_DENSE_STATE_BW));
+
+  // one instruction, nothing for the host to poll
+  instr.SetUpdate(m.state(RELAY_DATA_OUT), BvConst(0, RELAY_DATA_OUT_BITWIDTH));
+  instr.SetUpdate(m.state(RELAY_FUNC_DONE),
+                  BvConst(RELAY_FUNC_DONE_OFF, RELAY_FUNC_DONE_BITWIDTH));
+}
+
+} // namespace relay
+
+} // namespace ilang
@@ -45,6 +45,35 @@ void DefineTensorStore(Ila& m) {
   auto data = m.input(RELAY_DATA_IN);
 
   instr.SetUpdate(tensor, Store(tensor, addr, data));
+  instr.SetUpdate(m.state(RELAY_FUNC_DONE),
+                  BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH));
+}
+
+void DefineTensorStoreBurst(Ila& m) {
+  auto instr = m.NewInstr(F_TENSOR_STORE_BURST);
+
+  auto func_run = (m.input(RELAY_FUNC_RUN_IN) == RELAY_FUNC_RUN_ON);
+  auto func_id_match = (m.input(RELAY_FUNC_ID_IN) == F_TENSOR_STORE_BURST_ID);
+
+  instr.SetDecode(func_run & func_id_match);
+
+  auto tensor = m.state(RELAY_TENSOR_MEM);
+  auto addr = m.input(DATA_IN_Y);
+  auto line = m.input(RELAY_DATA_IN_WIDE);
+  auto len = m.input(RELAY_BURST_LEN_IN);
+
+  // bytes at and after len are left untouched
+  auto len_full = (len == 0) | !(len < RELAY_DATA_IN_WIDE_BYTES);
+  auto tensor_next = tensor;
+  for (auto i = 0; i < RELAY_DATA_IN_WIDE_BYTES; i++) {
+    auto data = Extract(line, 8 * i + 7, 8 * i);
+    auto valid = len_full | (BvConst(i, RELAY_BURST_LEN_IN_BITWIDTH) < len);
+    tensor_next = Ite(valid, Store(tensor_next, addr + i, data), tensor_next);
+  }
+
+  instr.SetUpdate(tensor, tensor_next);
+  instr.SetUpdate(m.state(RELAY_FUNC_DONE),
+                  BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH));
 }
 
 } // namespace relay
@@ -55,18 +55,19 @@ Ila GetRelayIla(const std::string& model_name) {
   // define Relay instructions
   auto vector_child = m.NewChild(RELAY_VECTOR_OP_CHILD);
   vector_child.SetValid(is_func_call & is_valid_func);
-  DefineVectorAdd(m);
-  DefineVectorMultiply(m);
-  DefineVectorSigmoid(m);
-  DefineVectorTanh(m);
+  DefineVectorOp(m);
 
   auto nn_child = m.NewChild(RELAY_NN_CHILD);
   nn_child.SetValid(is_func_call & is_valid_func);
   DefineNNDense(m);
+  DefineNNDenseFunc(m);
 
   DefineLSTM(m);
 
   DefineTensorStore(m);
+  DefineTensorStoreBurst(m);
+  DefineDataOut(m);
+  DefineReset(m);
   DefineMaxpooling2D(m);
 
   return m;
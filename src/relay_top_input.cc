@@ -39,6 +39,11 @@ void DefineTopInput(Ila& m) {
   m.NewBvInput(RELAY_FUNC_ID_IN, RELAY_FUNC_ID_IN_BITWIDTH);
   // define top data input here
   m.NewBvInput(RELAY_DATA_IN, RELAY_DATA_IN_BITWIDTH);
+  // define top wide data input and burst length for burst stores
+  m.NewBvInput(RELAY_DATA_IN_WIDE, RELAY_DATA_IN_WIDE_BITWIDTH);
+  m.NewBvInput(RELAY_BURST_LEN_IN, RELAY_BURST_LEN_IN_BITWIDTH);
+  // define the memory select of the data out function
+  m.NewBvInput(RELAY_DATA_OUT_MEM_IN, RELAY_DATA_OUT_MEM_IN_BITWIDTH);
 }
 
 } // namespace relay
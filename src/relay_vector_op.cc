@@ -24,73 +24,63 @@
 
 // File: relay_vector_op.cc
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include <relay/relay_top.h>
 
 namespace ilang {
 
 namespace relay {
 
-void DefineVectorAdd(Ila& m) {
-  auto vector_child = m.child(RELAY_VECTOR_OP_CHILD);
-  auto instr = vector_child.NewInstr(RELAY_VECTOR_ADD);
-
-  auto vector_add_enable = m.state(RELAY_VECTOR_ADD_ENABLE);
-  auto child_start = m.state(RELAY_VECTOR_ADD_START);
-
-  instr.SetDecode(
-      (vector_add_enable == RELAY_FLAG_ON) &
-      (m.state(RELAY_VECTOR_OP_SIZE) != BvConst(0, RELAY_VECTOR_OP_SIZE_BW)) &
-      (child_start == RELAY_FLAG_OFF));
-  auto cntr = m.state(RELAY_VECTOR_OP_CNTR);
-
-  auto memory = m.state(RELAY_MEMORY);
-
-  instr.SetUpdate(child_start, BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-  instr.SetUpdate(cntr, BvConst(0, RELAY_VECTOR_OP_CNTR_BW));
-
-  {
-    auto child = vector_child.NewChild(RELAY_VECTOR_ADD_CHILD);
-    auto child_started = (child_start == RELAY_FLAG_ON);
-    child.SetValid(child_started);
-    {
-      auto child_instr = child.NewInstr(RELAY_VECTOR_ADD_CHILD_INSTR);
-      child_instr.SetDecode(child_started);
-
-      auto addr_offset = cntr * RELAY_VECTOR_DATA_BYTES;
-      auto op0_addr = m.state(RELAY_VECTOR_ADD_OP0_ADDR) + addr_offset;
-      auto op1_addr = m.state(RELAY_VECTOR_ADD_OP1_ADDR) + addr_offset;
-      auto output_addr = m.state(RELAY_VECTOR_ADD_OUTPUT_ADDR) + addr_offset;
-      // uninterpreted add function
-      auto result = bv_add(RELAY_LOAD_WORD(memory, op0_addr),
-                           RELAY_LOAD_WORD(memory, op1_addr));
-
-      auto next_cntr = cntr + BvConst(1, RELAY_VECTOR_OP_CNTR_BW);
-      auto continue_cond = (next_cntr != m.state(RELAY_VECTOR_OP_SIZE));
-      auto next_child_start = RELAY_ITE_FLAG(continue_cond);
-      auto next_vector_add_enable = RELAY_ITE_FLAG(continue_cond);
-      auto lstm_state = m.state(RELAY_LSTM_STATE);
-      auto next_lstm_state =
-          Ite(continue_cond, lstm_state, m.state(RELAY_LSTM_RETURN_STATE));
-
-      child_instr.SetUpdate(memory,
-                            RELAY_STORE_WORD(memory, output_addr, result));
-      child_instr.SetUpdate(cntr, next_cntr);
-      child_instr.SetUpdate(child_start, next_child_start);
-      child_instr.SetUpdate(vector_add_enable, next_vector_add_enable);
-      child_instr.SetUpdate(lstm_state, next_lstm_state);
-    }
-  }
-}
+void DefineVectorOpFunc(Ila& m);
+
+// one entry per element-wise op: opcode, child instructions and the
+// functions applied to (op0[i], op1[i]) and to a tile of
+// RELAY_VECTOR_OP_TILE elements; unary ops do not read op1
+struct VectorOpEntry {
+  int opcode;
+  std::string instr_name;
+  std::string tile_instr_name;
+  bool binary;
+  std::function<ExprRef(const ExprRef&, const ExprRef&)> func;
+  std::function<ExprRef(const ExprRef&, const ExprRef&)> tile_func;
+};
+
+static const std::vector<VectorOpEntry> vector_op_table = {
+    {RELAY_VECTOR_OPCODE_ADD, RELAY_VECTOR_ADD_CHILD_INSTR,
+     RELAY_VECTOR_ADD_TILE_INSTR, true,
+     [](const ExprRef& a, const ExprRef& b) { return bv_add(a, b); },
+     [](const ExprRef& a, const ExprRef& b) { return bv_add_tile(a, b); }},
+    {RELAY_VECTOR_OPCODE_MULTIPLY, RELAY_VECTOR_MULTIPLY_CHILD_INSTR,
+     RELAY_VECTOR_MULTIPLY_TILE_INSTR, true,
+     [](const ExprRef& a, const ExprRef& b) { return bv_multiply(a, b); },
+     [](const ExprRef& a, const ExprRef& b) {
+       return bv_multiply_tile(a, b);
+     }},
+    {RELAY_VECTOR_OPCODE_SIGMOID, RELAY_VECTOR_SIGMOID_CHILD_INSTR,
+     RELAY_VECTOR_SIGMOID_TILE_INSTR, false,
+     [](const ExprRef& a, const ExprRef& b) { return bv_sigmoid(a); },
+     [](const ExprRef& a, const ExprRef& b) { return bv_sigmoid_tile(a); }},
+    {RELAY_VECTOR_OPCODE_TANH, RELAY_VECTOR_TANH_CHILD_INSTR,
+     RELAY_VECTOR_TANH_TILE_INSTR, false,
+     [](const ExprRef& a, const ExprRef& b) { return bv_tanh(a); },
+     [](const ExprRef& a, const ExprRef& b) { return bv_tanh_tile(a); }},
+};
+
+void DefineVectorOp(Ila& m) {
+  DefineVectorOpFunc(m);
 
-void DefineVectorMultiply(Ila& m) {
   auto vector_child = m.child(RELAY_VECTOR_OP_CHILD);
-  auto instr = vector_child.NewInstr(RELAY_VECTOR_MULTIPLY);
+  auto instr = vector_child.NewInstr(RELAY_VECTOR_OP_INSTR);
 
-  auto vector_multiply_enable = m.state(RELAY_VECTOR_MULTIPLY_ENABLE);
-  auto child_start = m.state(RELAY_VECTOR_MULTIPLY_START);
+  auto vector_op_enable = m.state(RELAY_VECTOR_OP_ENABLE);
+  auto child_start = m.state(RELAY_VECTOR_OP_START);
+  auto opcode = m.state(RELAY_VECTOR_OPCODE);
 
   instr.SetDecode(
-      (vector_multiply_enable == RELAY_FLAG_ON) &
+      (vector_op_enable == RELAY_FLAG_ON) &
       (m.state(RELAY_VECTOR_OP_SIZE) != BvConst(0, RELAY_VECTOR_OP_SIZE_BW)) &
       (child_start == RELAY_FLAG_OFF));
 
@@ -102,144 +92,156 @@ void DefineVectorMultiply(Ila& m) {
   instr.SetUpdate(cntr, BvConst(0, RELAY_VECTOR_OP_CNTR_BW));
 
   {
-    auto child = vector_child.NewChild(RELAY_VECTOR_MULTIPLY_CHILD);
+    auto child = vector_child.NewChild(RELAY_VECTOR_OP_LOOP_CHILD);
     auto child_started = (child_start == RELAY_FLAG_ON);
     child.SetValid(child_started);
-    {
-      auto child_instr = child.NewInstr(RELAY_VECTOR_MULTIPLY_CHILD_INSTR);
-      child_instr.SetDecode(child_started);
-
-      auto addr_offset = cntr * RELAY_VECTOR_DATA_BYTES;
-      auto op0_addr = m.state(RELAY_VECTOR_MULTIPLY_OP0_ADDR) + addr_offset;
-      auto op1_addr = m.state(RELAY_VECTOR_MULTIPLY_OP1_ADDR) + addr_offset;
-      auto output_addr =
-          m.state(RELAY_VECTOR_MULTIPLY_OUTPUT_ADDR) + addr_offset;
-      // uninterpreted add function
-      auto result = bv_multiply(RELAY_LOAD_WORD(memory, op0_addr),
-                                RELAY_LOAD_WORD(memory, op1_addr));
-
-      auto next_cntr = cntr + BvConst(1, RELAY_VECTOR_OP_CNTR_BW);
-      auto continue_cond = (next_cntr != m.state(RELAY_VECTOR_OP_SIZE));
-      auto next_child_start = RELAY_ITE_FLAG(continue_cond);
-      auto next_vector_multiply_enable = RELAY_ITE_FLAG(continue_cond);
-      auto lstm_state = m.state(RELAY_LSTM_STATE);
-      auto next_lstm_state =
-          Ite(continue_cond, lstm_state, m.state(RELAY_LSTM_RETURN_STATE));
-
-      child_instr.SetUpdate(memory,
-                            RELAY_STORE_WORD(memory, output_addr, result));
-      child_instr.SetUpdate(cntr, next_cntr);
-      child_instr.SetUpdate(child_start, next_child_start);
-      child_instr.SetUpdate(vector_multiply_enable,
-                            next_vector_multiply_enable);
-      child_instr.SetUpdate(lstm_state, next_lstm_state);
-    }
-  }
-}
-
-void DefineVectorSigmoid(Ila& m) {
-  auto vector_child = m.child(RELAY_VECTOR_OP_CHILD);
-  auto instr = vector_child.NewInstr(RELAY_VECTOR_SIGMOID);
-
-  auto vector_sigmoid_enable = m.state(RELAY_VECTOR_SIGMOID_ENABLE);
-  auto child_start = m.state(RELAY_VECTOR_SIGMOID_START);
-
-  instr.SetDecode(
-      (vector_sigmoid_enable == RELAY_FLAG_ON) &
-      (m.state(RELAY_VECTOR_OP_SIZE) != BvConst(0, RELAY_VECTOR_OP_SIZE_BW)) &
-      (child_start == RELAY_FLAG_OFF));
 
-  auto cntr = m.state(RELAY_VECTOR_OP_CNTR);
-
-  auto memory = m.state(RELAY_MEMORY);
-
-  instr.SetUpdate(child_start, BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-  instr.SetUpdate(cntr, BvConst(0, RELAY_VECTOR_OP_CNTR_BW));
-
-  {
-    auto child = vector_child.NewChild(RELAY_VECTOR_SIGMOID_CHILD);
-    auto child_started = (child_start == RELAY_FLAG_ON);
-    child.SetValid(child_started);
-    {
-      auto child_instr = child.NewInstr(RELAY_VECTOR_SIGMOID_CHILD_INSTR);
-      child_instr.SetDecode(child_started);
-
-      auto addr_offset = cntr * RELAY_VECTOR_DATA_BYTES;
-      auto op0_addr = m.state(RELAY_VECTOR_SIGMOID_OP0_ADDR) + addr_offset;
-      auto output_addr =
-          m.state(RELAY_VECTOR_SIGMOID_OUTPUT_ADDR) + addr_offset;
-      // uninterpreted sigmoid function
-      auto result = bv_sigmoid(RELAY_LOAD_WORD(memory, op0_addr));
-
-      auto next_cntr = cntr + 1;
+    // element cntr of each operand, stride 0 keeps reading the same element
+    auto op0_stride = m.state(RELAY_VECTOR_OP0_STRIDE);
+    auto op1_stride = m.state(RELAY_VECTOR_OP1_STRIDE);
+    auto output_stride = m.state(RELAY_VECTOR_OUTPUT_STRIDE);
+    auto op0_addr = m.state(RELAY_VECTOR_OP0_ADDR) + cntr * op0_stride;
+    auto op1_addr = m.state(RELAY_VECTOR_OP1_ADDR) + cntr * op1_stride;
+    auto output_addr = m.state(RELAY_VECTOR_OUTPUT_ADDR) + cntr * output_stride;
+
+    // loop updates of an instruction that handled the elements up to
+    // next_cntr
+    auto lstm_state = m.state(RELAY_LSTM_STATE);
+    auto func_done = m.state(RELAY_FUNC_DONE);
+    auto return_wait = (m.state(RELAY_LSTM_RETURN_STATE) ==
+                        BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
+    auto set_next = [&](InstrRef& child_instr, const ExprRef& next_cntr) {
       auto continue_cond = (next_cntr != m.state(RELAY_VECTOR_OP_SIZE));
-      auto next_child_start = RELAY_ITE_FLAG(continue_cond);
-      auto next_vector_sigmoid_enable = RELAY_ITE_FLAG(continue_cond);
-
-      auto lstm_state = m.state(RELAY_LSTM_STATE);
-      auto next_lstm_state =
-          Ite(continue_cond, lstm_state, m.state(RELAY_LSTM_RETURN_STATE));
-
-      child_instr.SetUpdate(memory,
-                            RELAY_STORE_WORD(memory, output_addr, result));
       child_instr.SetUpdate(cntr, next_cntr);
-      child_instr.SetUpdate(child_start, next_child_start);
-      child_instr.SetUpdate(vector_sigmoid_enable, next_vector_sigmoid_enable);
-      child_instr.SetUpdate(lstm_state, next_lstm_state);
+      child_instr.SetUpdate(child_start, RELAY_ITE_FLAG(continue_cond));
+      child_instr.SetUpdate(vector_op_enable, RELAY_ITE_FLAG(continue_cond));
+      child_instr.SetUpdate(
+          lstm_state,
+          Ite(continue_cond, lstm_state, m.state(RELAY_LSTM_RETURN_STATE)));
+      // a direct call (nothing to return to) is done after the last element
+      child_instr.SetUpdate(
+          func_done,
+          Ite(!continue_cond & return_wait,
+              BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH),
+              func_done));
+    };
+
+    // a whole tile is left, the tail runs one element per instruction
+    auto tile_fits =
+        !((m.state(RELAY_VECTOR_OP_SIZE) - cntr) <
+          BvConst(RELAY_VECTOR_OP_TILE, RELAY_VECTOR_OP_CNTR_BW));
+
+    for (auto& op : vector_op_table) {
+      auto opcode_match =
+          (opcode == BvConst(op.opcode, RELAY_VECTOR_OPCODE_BW));
+      {
+        auto child_instr = child.NewInstr(op.instr_name);
+        child_instr.SetDecode(child_started & opcode_match & !tile_fits);
+
+        // uninterpreted element function
+        auto op0 = RELAY_LOAD_WORD(memory, op0_addr);
+        auto result =
+            op.func(op0, op.binary ? RELAY_LOAD_WORD(memory, op1_addr) : op0);
+
+        child_instr.SetUpdate(memory,
+                              RELAY_STORE_WORD(memory, output_addr, result));
+        set_next(child_instr, cntr + BvConst(1, RELAY_VECTOR_OP_CNTR_BW));
+      }
+      {
+        auto tile_instr = child.NewInstr(op.tile_instr_name);
+        tile_instr.SetDecode(child_started & opcode_match & tile_fits);
+
+        // pack the tiles, element k lives in bits [32k+31:32k]; all operands
+        // are read before the first store, as the elements do as long as the
+        // output is not an operand shifted by less than a tile
+        auto element = [&](const ExprRef& addr, const ExprRef& stride, int k) {
+          return addr + BvConst(k, RELAY_VECTOR_ADDR_BW) * stride;
+        };
+        auto load_tile = [&](const ExprRef& addr,
+                             const ExprRef& stride) -> ExprRef {
+          auto tile = RELAY_LOAD_WORD(memory, addr);
+          for (auto k = 1; k < RELAY_VECTOR_OP_TILE; k++) {
+            tile = Concat(RELAY_LOAD_WORD(memory, element(addr, stride, k)),
+                          tile);
+          }
+          return tile;
+        };
+        auto op0_tile = load_tile(op0_addr, op0_stride);
+        auto result = op.tile_func(
+            op0_tile, op.binary ? load_tile(op1_addr, op1_stride) : op0_tile);
+
+        // stored in element order, so a 0 output stride keeps the last one
+        auto next_memory = memory;
+        for (auto k = 0; k < RELAY_VECTOR_OP_TILE; k++) {
+          auto word = Extract(result, RELAY_VECTOR_DATA_BW * k +
+                                          RELAY_VECTOR_DATA_BW - 1,
+                              RELAY_VECTOR_DATA_BW * k);
+          next_memory = RELAY_STORE_WORD(
+              next_memory, element(output_addr, output_stride, k), word);
+        }
+
+        tile_instr.SetUpdate(memory, next_memory);
+        set_next(tile_instr,
+                 cntr + BvConst(RELAY_VECTOR_OP_TILE, RELAY_VECTOR_OP_CNTR_BW));
+      }
     }
   }
 }
 
-void DefineVectorTanh(Ila& m) {
-  auto vector_child = m.child(RELAY_VECTOR_OP_CHILD);
-  auto instr = vector_child.NewInstr(RELAY_VECTOR_TANH);
-
-  auto vector_tanh_enable = m.state(RELAY_VECTOR_TANH_ENABLE);
-  auto child_start = m.state(RELAY_VECTOR_TANH_START);
-
-  instr.SetDecode(
-      (vector_tanh_enable == RELAY_FLAG_ON) &
-      (m.state(RELAY_VECTOR_OP_SIZE) != BvConst(0, RELAY_VECTOR_OP_SIZE_BW)) &
-      (child_start == RELAY_FLAG_OFF));
-
-  auto cntr = m.state(RELAY_VECTOR_OP_CNTR);
+void DefineVectorOpFunc(Ila& m) {
+  auto instr = m.NewInstr(F_VECTOR_OP);
 
-  auto memory = m.state(RELAY_MEMORY);
+  auto func_id_match = (m.input(RELAY_FUNC_ID_IN) == F_VECTOR_OP_ID);
+  auto func_run = (m.input(RELAY_FUNC_RUN_IN) == RELAY_FUNC_RUN_ON);
 
-  instr.SetUpdate(child_start, BvConst(RELAY_FLAG_ON, RELAY_FLAG_BW));
-  instr.SetUpdate(cntr, BvConst(0, RELAY_VECTOR_OP_CNTR_BW));
+  instr.SetDecode(func_id_match & func_run);
 
-  {
-    auto child = vector_child.NewChild(RELAY_VECTOR_TANH_CHILD);
-    auto child_started = (child_start == RELAY_FLAG_ON);
-    child.SetValid(child_started);
-    {
-      auto child_instr = child.NewInstr(RELAY_VECTOR_TANH_CHILD_INSTR);
-      child_instr.SetDecode(child_started);
-
-      auto addr_offset = cntr * RELAY_VECTOR_DATA_BYTES;
-      auto op0_addr = m.state(RELAY_VECTOR_TANH_OP0_ADDR) + addr_offset;
-      auto output_addr = m.state(RELAY_VECTOR_TANH_OUTPUT_ADDR) + addr_offset;
-      // uninterpreted sigmoid function
-      auto result = bv_tanh(RELAY_LOAD_WORD(memory, op0_addr));
-
-      auto next_cntr = cntr + 1;
-      auto continue_cond = (next_cntr != m.state(RELAY_VECTOR_OP_SIZE));
-      auto next_child_start = RELAY_ITE_FLAG(continue_cond);
-      auto next_vector_tanh_enable = RELAY_ITE_FLAG(continue_cond);
-
-      auto lstm_state = m.state(RELAY_LSTM_STATE);
-      auto next_lstm_state =
-          Ite(continue_cond, lstm_state, m.state(RELAY_LSTM_RETURN_STATE));
-
-      child_instr.SetUpdate(memory,
-                            RELAY_STORE_WORD(memory, output_addr, result));
-      child_instr.SetUpdate(cntr, next_cntr);
-      child_instr.SetUpdate(child_start, next_child_start);
-      child_instr.SetUpdate(vector_tanh_enable, next_vector_tanh_enable);
-      child_instr.SetUpdate(lstm_state, next_lstm_state);
-    }
+  // an opcode without a table entry has no child instruction to step the
+  // loop, so the engine is not enabled for it
+  auto func_opcode = m.input(RELAY_VECTOR_FUNC_OPCODE);
+  auto known_opcode = BoolConst(false);
+  for (auto& op : vector_op_table) {
+    known_opcode =
+        known_opcode |
+        (func_opcode == BvConst(op.opcode, RELAY_VECTOR_OPCODE_BW));
   }
+
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP_ENABLE),
+                  RELAY_ITE_FLAG(known_opcode));
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP_START),
+                  BvConst(RELAY_FLAG_OFF, RELAY_FLAG_BW));
+
+  instr.SetUpdate(m.state(RELAY_VECTOR_OPCODE),
+                  m.input(RELAY_VECTOR_FUNC_OPCODE));
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP_SIZE),
+                  m.input(RELAY_VECTOR_FUNC_SIZE));
+
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP0_ADDR),
+                  m.input(RELAY_VECTOR_FUNC_OP0_ADDR));
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP1_ADDR),
+                  m.input(RELAY_VECTOR_FUNC_OP1_ADDR));
+  instr.SetUpdate(m.state(RELAY_VECTOR_OUTPUT_ADDR),
+                  m.input(RELAY_VECTOR_FUNC_OUTPUT_ADDR));
+
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP0_STRIDE),
+                  m.input(RELAY_VECTOR_FUNC_OP0_STRIDE));
+  instr.SetUpdate(m.state(RELAY_VECTOR_OP1_STRIDE),
+                  m.input(RELAY_VECTOR_FUNC_OP1_STRIDE));
+  instr.SetUpdate(m.state(RELAY_VECTOR_OUTPUT_STRIDE),
+                  m.input(RELAY_VECTOR_FUNC_OUTPUT_STRIDE));
+
+  // nothing to return to once the last element is written
+  instr.SetUpdate(m.state(RELAY_LSTM_RETURN_STATE),
+                  BvConst(RELAY_WAIT_STATE, RELAY_LSTM_STATE_BW));
+
+  // an empty vector or an unknown opcode never starts the child, so the
+  // call is done at once (and writes nothing)
+  auto empty = (m.input(RELAY_VECTOR_FUNC_SIZE) ==
+                BvConst(0, RELAY_VECTOR_OP_SIZE_BW));
+  auto done_on = BvConst(RELAY_FUNC_DONE_ON, RELAY_FUNC_DONE_BITWIDTH);
+  auto done_off = BvConst(RELAY_FUNC_DONE_OFF, RELAY_FUNC_DONE_BITWIDTH);
+  instr.SetUpdate(m.state(RELAY_FUNC_DONE),
+                  Ite(empty | !known_opcode, done_on, done_off));
 }
 
 } // namespace relay
@@ -0,0 +1,138 @@
+// File: relay_paged_mem.h
+//
+// Flat paged-array memory for the generated simulator. Drop-in for the
+// std::map<int, T> the generator emits for memory states (relay_memory,
+// relay_tensor_mem): operator[], find/end, count, begin/end and clear keep
+// the map interface, but an address is a page table index plus an offset
+// instead of a tree walk. Pages are allocated (zero-filled) on first access,
+// so untouched address ranges cost only a null page pointer.
+//
+// Installed into sim_model/include by `./relay --paged-mem`.
+
+#ifndef RELAY_PAGED_MEM_H__
+#define RELAY_PAGED_MEM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// 4K words per page
+#define RELAY_PAGE_BITS 12
+#define RELAY_PAGE_SIZE (1u << RELAY_PAGE_BITS)
+#define RELAY_PAGE_MASK (RELAY_PAGE_SIZE - 1)
+
+template <class T>
+class relay_paged_mem
+{
+public:
+  // each slot keeps its address so iterators look like map iterators
+  typedef std::pair<int, T> value_type;
+
+  class iterator
+  {
+  public:
+    iterator() : mem_(NULL), page_(0), off_(0) {}
+    iterator(relay_paged_mem* mem, size_t page, size_t off)
+        : mem_(mem), page_(page), off_(off) {}
+
+    value_type& operator*() const { return mem_->pages_[page_][off_]; }
+    value_type* operator->() const { return &mem_->pages_[page_][off_]; }
+
+    iterator& operator++()
+    {
+      if (++off_ == RELAY_PAGE_SIZE) {
+        off_ = 0;
+        page_ = mem_->next_page(page_ + 1);
+      }
+      return *this;
+    }
+    iterator operator++(int)
+    {
+      iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const iterator& o) const
+    {
+      return page_ == o.page_ && off_ == o.off_;
+    }
+    bool operator!=(const iterator& o) const { return !(*this == o); }
+
+  private:
+    relay_paged_mem* mem_;
+    size_t page_;
+    size_t off_;
+  };
+
+  relay_paged_mem() {}
+  relay_paged_mem(const relay_paged_mem& o) { *this = o; }
+  relay_paged_mem& operator=(const relay_paged_mem& o)
+  {
+    if (this == &o)
+      return *this;
+    pages_.clear();
+    pages_.resize(o.pages_.size());
+    for (size_t i = 0; i < o.pages_.size(); i++) {
+      if (o.pages_[i]) {
+        pages_[i].reset(new value_type[RELAY_PAGE_SIZE]);
+        std::copy(o.pages_[i].get(), o.pages_[i].get() + RELAY_PAGE_SIZE,
+                  pages_[i].get());
+      }
+    }
+    return *this;
+  }
+
+  T& operator[](int addr) { return slot(addr).second; }
+
+  // slots of allocated pages are found (and read as 0 until written)
+  iterator find(int addr)
+  {
+    size_t page = page_of(addr);
+    if (page >= pages_.size() || !pages_[page])
+      return end();
+    return iterator(this, page, static_cast<uint32_t>(addr) & RELAY_PAGE_MASK);
+  }
+  size_t count(int addr) { return find(addr) == end() ? 0 : 1; }
+
+  iterator begin() { return iterator(this, next_page(0), 0); }
+  iterator end() { return iterator(this, pages_.size(), 0); }
+
+  bool empty() const { return pages_.empty(); }
+  void clear() { pages_.clear(); }
+
+private:
+  static size_t page_of(int addr)
+  {
+    return static_cast<uint32_t>(addr) >> RELAY_PAGE_BITS;
+  }
+
+  size_t next_page(size_t page) const
+  {
+    while (page < pages_.size() && !pages_[page])
+      page++;
+    return page;
+  }
+
+  value_type& slot(int addr)
+  {
+    size_t page = page_of(addr);
+    if (page >= pages_.size())
+      pages_.resize(page + 1);
+    if (!pages_[page]) {
+      value_type* p = new value_type[RELAY_PAGE_SIZE]();
+      int base = static_cast<int>(page << RELAY_PAGE_BITS);
+      for (size_t i = 0; i < RELAY_PAGE_SIZE; i++)
+        p[i].first = base + static_cast<int>(i);
+      pages_[page].reset(p);
+    }
+    return pages_[page][static_cast<uint32_t>(addr) & RELAY_PAGE_MASK];
+  }
+
+  std::vector<std::unique_ptr<value_type[]> > pages_;
+};
+
+#endif // RELAY_PAGED_MEM_H__
@@ -0,0 +1,313 @@
+// File: relay_uf_kernels.h
+//
+// Kernels behind the UFs in uninterpreted_func.cc, on raw words and bytes
+// and without SystemC, so they can be tested on their own (test/).
+// Copied into sim_model/extern together with uninterpreted_func.cc.
+
+#ifndef RELAY_UF_KERNELS_H__
+#define RELAY_UF_KERNELS_H__
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#define UF_AVX2 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define UF_NEON 1
+#include <arm_neon.h>
+#endif
+
+/** raw word <-> float, memcpy instead of pointer punning **/
+static inline float word_to_float(uint32_t w)
+{
+  float f;
+  memcpy(&f, &w, sizeof(f));
+  return f;
+}
+
+static inline uint32_t float_to_word(float f)
+{
+  uint32_t w;
+  memcpy(&w, &f, sizeof(w));
+  return w;
+}
+
+/** uint32_t fast path, no sc_biguint involved **/
+static inline uint32_t fp_add(uint32_t op0, uint32_t op1)
+{
+  return float_to_word(word_to_float(op0) + word_to_float(op1));
+}
+
+static inline uint32_t fp_multiply(uint32_t op0, uint32_t op1)
+{
+  return float_to_word(word_to_float(op0) * word_to_float(op1));
+}
+
+static inline uint32_t fp_fma(uint32_t op0, uint32_t op1, uint32_t op2)
+{
+  return float_to_word(
+      fmaf(word_to_float(op0), word_to_float(op1), word_to_float(op2)));
+}
+
+#ifdef RELAY_FAST_ACTIVATION
+/**
+ * Table + cubic polynomial: the functions are split into intervals of
+ * 1/ACT_TABLE_STEP, each holding the coefficients of the cubic Hermite
+ * through its end points (values and slopes), evaluated by Horner's rule.
+ * tanh: intervals on [0, ACT_TABLE_RANGE], slope 1 - tanh^2, odd symmetry,
+ * |x| >= ACT_TABLE_RANGE saturates to +-1.
+ * sigmoid: intervals of the lower half sigmoid(-|x|) on
+ * [0, SIGMOID_TABLE_RANGE], slope -s(1-s), and 1 - sigmoid(-|x|) for positive
+ * x. Interpolating the lower half keeps the relative error of the small
+ * results (1/2 + tanh(x/2)/2 would cancel them); below the table sigmoid is
+ * 1 / (1 + expf(-x)), above it saturates to 1.
+ * The error bounds against double-precision libm and the speedup over it are
+ * checked by test/fast_activation_test.cc.
+ */
+#define ACT_TABLE_STEP 32
+#define ACT_TABLE_RANGE 8
+#define SIGMOID_TABLE_RANGE 16
+
+struct act_interval_t {
+  float c0, c1, c2, c3;
+};
+
+// intervals of f from 0 around each multiple of 1/ACT_TABLE_STEP up to
+// N / ACT_TABLE_STEP, slope df, coefficients in the offset t from the center
+template <int N>
+struct act_table_t {
+  act_interval_t seg[N + 1];
+  act_table_t(double (*f)(double), double (*df)(double))
+  {
+    for (int i = 0; i <= N; i++) {
+      // interval i is [i - 1/2, i + 1/2] / ACT_TABLE_STEP, except for the
+      // first one, [0, 1] / ACT_TABLE_STEP, so that 0 maps to c0 = f(0)
+      double h = (i == 0) ? 0 : 0.5;
+      double x0 = (i - h) / ACT_TABLE_STEP;
+      double x1 = (i - h + 1) / ACT_TABLE_STEP;
+      double y0 = f(x0), y1 = f(x1);
+      double d0 = df(x0) / ACT_TABLE_STEP, d1 = df(x1) / ACT_TABLE_STEP;
+      // Hermite in s = t + h
+      double c0 = y0, c1 = d0;
+      double c2 = 3 * (y1 - y0) - 2 * d0 - d1;
+      double c3 = 2 * (y0 - y1) + d0 + d1;
+      seg[i].c0 = c0 + (c1 + (c2 + c3 * h) * h) * h;
+      seg[i].c1 = c1 + (2 * c2 + 3 * c3 * h) * h;
+      seg[i].c2 = c2 + 3 * c3 * h;
+      seg[i].c3 = c3;
+    }
+  }
+
+  // a in [0, N / ACT_TABLE_STEP); the magic constant rounds p to the
+  // nearest integer i in the low mantissa bits (no float <-> int
+  // conversions), t = p - i is in [-1/2, 1/2]
+  float eval(float a) const
+  {
+    const float round_magic = 12582912.0f; // 1.5 * 2^23
+    float p = a * ACT_TABLE_STEP;
+    float r = p + round_magic;
+    uint32_t i = float_to_word(r) & 0x3FFFFF;
+    float t = p - (r - round_magic);
+    const act_interval_t& s = seg[i];
+    return ((s.c3 * t + s.c2) * t + s.c1) * t + s.c0;
+  }
+};
+
+static double act_tanh(double a) { return tanh(a); }
+static double act_tanh_slope(double a) { return 1 - tanh(a) * tanh(a); }
+static double act_sigmoid_lower(double a) { return 1 / (1 + exp(a)); }
+static double act_sigmoid_lower_slope(double a)
+{
+  double y = act_sigmoid_lower(a);
+  return -y * (1 - y);
+}
+
+static const act_table_t<ACT_TABLE_STEP * ACT_TABLE_RANGE>
+    tanh_table(act_tanh, act_tanh_slope);
+static const act_table_t<ACT_TABLE_STEP * SIGMOID_TABLE_RANGE>
+    sigmoid_table(act_sigmoid_lower, act_sigmoid_lower_slope);
+
+static inline float fast_tanh(float x)
+{
+  float a = fabsf(x);
+  if (a != a) {
+    return x; // NaN
+  }
+  if (!(a < ACT_TABLE_RANGE)) {
+    return copysignf(1.0f, x);
+  }
+  return copysignf(tanh_table.eval(a), x);
+}
+
+static inline float fast_sigmoid(float x)
+{
+  float a = fabsf(x);
+  if (!(a < SIGMOID_TABLE_RANGE)) {
+    // the reciprocal of a large 1 + exp(-x) keeps its relative precision,
+    // NaN gets here too and stays NaN
+    return x > 0 ? 1.0f : 1.0f / (1.0f + expf(-x));
+  }
+  float lower = sigmoid_table.eval(a);
+  float upper = 1.0f - lower;
+  return x < 0 ? lower : upper;
+}
+
+static inline uint32_t fp_sigmoid(uint32_t op0)
+{
+  return float_to_word(fast_sigmoid(word_to_float(op0)));
+}
+
+static inline uint32_t fp_tanh(uint32_t op0)
+{
+  return float_to_word(fast_tanh(word_to_float(op0)));
+}
+#else
+static inline uint32_t fp_sigmoid(uint32_t op0)
+{
+  return float_to_word(1.0 / (exp(-word_to_float(op0)) + 1));
+}
+
+static inline uint32_t fp_tanh(uint32_t op0)
+{
+  return float_to_word(tanh(word_to_float(op0)));
+}
+#endif
+
+/** array form over n contiguous words (out may alias an operand), behind the
+ * tile UFs of the vector engine; the same results as the fp_* ops **/
+static inline void relay_vector_add(const uint32_t* op0, const uint32_t* op1,
+                                    uint32_t* out, size_t n)
+{
+  size_t i = 0;
+#if defined(UF_AVX2)
+  for (; i + 8 <= n; i += 8) {
+    __m256 a = _mm256_loadu_ps((const float*)(op0 + i));
+    __m256 b = _mm256_loadu_ps((const float*)(op1 + i));
+    _mm256_storeu_ps((float*)(out + i), _mm256_add_ps(a, b));
+  }
+#elif defined(UF_NEON)
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t a = vld1q_f32((const float*)(op0 + i));
+    float32x4_t b = vld1q_f32((const float*)(op1 + i));
+    vst1q_f32((float*)(out + i), vaddq_f32(a, b));
+  }
+#endif
+  for (; i < n; i++) {
+    out[i] = fp_add(op0[i], op1[i]);
+  }
+}
+
+static inline void relay_vector_multiply(const uint32_t* op0,
+                                         const uint32_t* op1, uint32_t* out,
+                                         size_t n)
+{
+  size_t i = 0;
+#if defined(UF_AVX2)
+  for (; i + 8 <= n; i += 8) {
+    __m256 a = _mm256_loadu_ps((const float*)(op0 + i));
+    __m256 b = _mm256_loadu_ps((const float*)(op1 + i));
+    _mm256_storeu_ps((float*)(out + i), _mm256_mul_ps(a, b));
+  }
+#elif defined(UF_NEON)
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t a = vld1q_f32((const float*)(op0 + i));
+    float32x4_t b = vld1q_f32((const float*)(op1 + i));
+    vst1q_f32((float*)(out + i), vmulq_f32(a, b));
+  }
+#endif
+  for (; i < n; i++) {
+    out[i] = fp_multiply(op0[i], op1[i]);
+  }
+}
+
+// no portable SIMD exp/tanh, one element at a time through fp_sigmoid and
+// fp_tanh (the table kernels with RELAY_FAST_ACTIVATION)
+static inline void relay_vector_sigmoid(const uint32_t* op0, uint32_t* out,
+                                        size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    out[i] = fp_sigmoid(op0[i]);
+  }
+}
+
+static inline void relay_vector_tanh(const uint32_t* op0, uint32_t* out,
+                                     size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    out[i] = fp_tanh(op0[i]);
+  }
+}
+
+/**
+ * adpfloat8: sign | 3-bit exponent | 4-bit mantissa, the exponent bias is
+ * shared by the whole tensor, so the order of two values only depends on the
+ * sign-magnitude bits. 0x00 and 0x80 both encode zero.
+ * The compare key flips the magnitude of negative values and sets the top bit
+ * of the others, which makes it an unsigned order: 0xFF (most negative) maps to
+ * 0x00, both zeros to 0x80 and 0x7F (most positive) to 0xFF.
+ */
+static inline uint8_t adpfloat_key(uint8_t v)
+{
+  uint8_t mag = v & 0x7F;
+  uint8_t neg = (uint8_t)(0 - ((v >> 7) & (mag != 0)));
+  return (uint8_t)((mag | 0x80) ^ neg);
+}
+
+// ties return op0, so both zeros keep their encoding
+static inline uint8_t adpfloat_max(uint8_t op0, uint8_t op1)
+{
+  return adpfloat_key(op0) < adpfloat_key(op1) ? op1 : op0;
+}
+
+#if defined(UF_AVX2)
+static inline __m256i adpfloat_key_avx2(__m256i v)
+{
+  __m256i mag = _mm256_and_si256(v, _mm256_set1_epi8(0x7F));
+  __m256i neg = _mm256_cmpgt_epi8(_mm256_setzero_si256(), v);
+  __m256i zero = _mm256_cmpeq_epi8(mag, _mm256_setzero_si256());
+  return _mm256_xor_si256(_mm256_or_si256(mag, _mm256_set1_epi8((char)0x80)),
+                          _mm256_andnot_si256(zero, neg));
+}
+#elif defined(UF_NEON)
+static inline uint8x16_t adpfloat_key_neon(uint8x16_t v)
+{
+  uint8x16_t mag = vandq_u8(v, vdupq_n_u8(0x7F));
+  uint8x16_t neg = vcltzq_s8(vreinterpretq_s8_u8(v));
+  uint8x16_t nonzero = vtstq_u8(v, vdupq_n_u8(0x7F));
+  return veorq_u8(vorrq_u8(mag, vdupq_n_u8(0x80)), vandq_u8(neg, nonzero));
+}
+#endif
+
+/** element-wise adpfloat max of two rows, e.g. a window row into the running
+ * maxima (out may alias an operand) **/
+static inline void relay_adpfloat_max_row(const uint8_t* op0,
+                                          const uint8_t* op1, uint8_t* out,
+                                          size_t n)
+{
+  size_t i = 0;
+#if defined(UF_AVX2)
+  for (; i + 32 <= n; i += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(op0 + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(op1 + i));
+    __m256i ka = adpfloat_key_avx2(a), kb = adpfloat_key_avx2(b);
+    __m256i keep_a = _mm256_cmpeq_epi8(_mm256_max_epu8(ka, kb), ka);
+    _mm256_storeu_si256((__m256i*)(out + i),
+                        _mm256_blendv_epi8(b, a, keep_a));
+  }
+#elif defined(UF_NEON)
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t a = vld1q_u8(op0 + i);
+    uint8x16_t b = vld1q_u8(op1 + i);
+    uint8x16_t keep_a = vcgeq_u8(adpfloat_key_neon(a), adpfloat_key_neon(b));
+    vst1q_u8(out + i, vbslq_u8(keep_a, a, b));
+  }
+#endif
+  for (; i < n; i++) {
+    out[i] = adpfloat_max(op0[i], op1[i]);
+  }
+}
+
+#endif // RELAY_UF_KERNELS_H__
@@ -0,0 +1,104 @@
+// File: adpfloat_max_test.cc
+//
+// Exhaustive check of the adpfloat8 max behind relay_adpfloat_max and
+// relay_adpfloat_max_16: all 65536 operand pairs against a compare of the
+// decoded values, through the scalar adpfloat_max and through
+// relay_adpfloat_max_row, which takes the AVX2 or NEON key path when the
+// kernels are built for it (see CMakeLists.txt) and the scalar tail otherwise.
+
+#include "../relay_uf_kernels.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <vector>
+
+#if defined(UF_AVX2)
+#define KEY_PATH "avx2"
+#elif defined(UF_NEON)
+#define KEY_PATH "neon"
+#else
+#define KEY_PATH "scalar"
+#endif
+
+// exit code ctest reads as skipped (SKIP_RETURN_CODE)
+#define TEST_SKIPPED 77
+
+// any shared bias gives the same order, a non-zero one checks that
+#define ADPFLOAT_BIAS -3
+
+/**
+ * adpfloat8: sign | 3-bit exponent | 4-bit mantissa with a hidden one, the
+ * value is (-1)^s * 1.m * 2^(e + bias), all-zero magnitude is zero.
+ */
+static double adpfloat_decode(uint8_t v)
+{
+  int mag = v & 0x7F;
+  if (mag == 0) {
+    return 0.0;
+  }
+  double value = ldexp(1.0 + (mag & 0xF) / 16.0, (mag >> 4) + ADPFLOAT_BIAS);
+  return (v & 0x80) ? -value : value;
+}
+
+// ties keep op0, the same as the UF
+static uint8_t ref_max(uint8_t op0, uint8_t op1)
+{
+  return adpfloat_decode(op0) < adpfloat_decode(op1) ? op1 : op0;
+}
+
+static int check(const char* name, const uint8_t* op0, const uint8_t* op1,
+                 const uint8_t* out, size_t n)
+{
+  int errors = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint8_t ref = ref_max(op0[i], op1[i]);
+    if (out[i] != ref && errors++ < 8) {
+      printf("%s: max(0x%02x, 0x%02x) = 0x%02x, expected 0x%02x\n", name,
+             op0[i], op1[i], out[i], ref);
+    }
+  }
+  printf("%-10s %zu pairs, %d errors\n", name, n, errors);
+  return errors;
+}
+
+int main()
+{
+#if defined(UF_AVX2)
+  if (!__builtin_cpu_supports("avx2")) {
+    printf("no avx2 on this cpu, skipped\n");
+    return TEST_SKIPPED;
+  }
+#endif
+  printf("key path: %s\n", KEY_PATH);
+
+  // all pairs, op0 in the high byte of the index
+  const size_t n = 1 << 16;
+  std::vector<uint8_t> op0(n), op1(n), out(n);
+  for (size_t i = 0; i < n; i++) {
+    op0[i] = (uint8_t)(i >> 8);
+    op1[i] = (uint8_t)i;
+  }
+
+  int errors = 0;
+  for (size_t i = 0; i < n; i++) {
+    out[i] = adpfloat_max(op0[i], op1[i]);
+  }
+  errors += check("scalar", op0.data(), op1.data(), out.data(), n);
+
+  relay_adpfloat_max_row(op0.data(), op1.data(), out.data(), n);
+  errors += check("row", op0.data(), op1.data(), out.data(), n);
+
+  // unaligned start and a length that leaves a scalar tail
+  std::fill(out.begin(), out.end(), 0);
+  relay_adpfloat_max_row(op0.data() + 3, op1.data() + 3, out.data() + 3,
+                         n - 10);
+  errors += check("row+tail", op0.data() + 3, op1.data() + 3, out.data() + 3,
+                  n - 10);
+
+  // in place, the running maxima of the maxpool window
+  std::vector<uint8_t> acc(op0);
+  relay_adpfloat_max_row(acc.data(), op1.data(), acc.data(), n);
+  errors += check("in place", op0.data(), op1.data(), acc.data(), n);
+
+  return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+// File: fast_activation_test.cc
+//
+// Error of the RELAY_FAST_ACTIVATION tanh/sigmoid against double-precision
+// libm over a sweep of all float bit patterns, and their speedup over the
+// libm versions (the default fp_tanh/fp_sigmoid). Relative error is taken
+// over normal (>= FLT_MIN) results.
+
+#define RELAY_FAST_ACTIVATION
+#include "../relay_uf_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <float.h>
+#include <stdio.h>
+#include <vector>
+
+// bounds checked by the test
+#define TANH_MAX_ABS_ERR 2.5e-7
+#define TANH_MAX_REL_ERR 3.5e-7
+#define SIGMOID_MAX_ABS_ERR 1.5e-7
+#define SIGMOID_MAX_REL_ERR 2e-7
+// minimum speedup over libm, with headroom for timing noise (measured about
+// 5x for tanh and 1.4x for sigmoid against glibc)
+#define TANH_MIN_SPEEDUP 2.0
+#define SIGMOID_MIN_SPEEDUP 1.15
+
+// timing runs over TIMING_INPUTS cache-resident inputs, fast and libm
+// interleaved, the fastest run of each counts
+#define TIMING_RUNS 100
+#define TIMING_INPUTS (1 << 14)
+
+// every SWEEP_STRIDE-th bit pattern (prime, so all exponents and mantissa
+// phases are hit), ~70M inputs
+#define SWEEP_STRIDE 61
+
+struct error_t {
+  double abs_err = 0, rel_err = 0;
+  float abs_at = 0, rel_at = 0;
+
+  void add(float x, float y, double ref)
+  {
+    double e = fabs((double)y - ref);
+    if (e > abs_err) {
+      abs_err = e;
+      abs_at = x;
+    }
+    if (fabs(ref) >= FLT_MIN && e / fabs(ref) > rel_err) {
+      rel_err = e / fabs(ref);
+      rel_at = x;
+    }
+  }
+};
+
+static double ref_sigmoid(double x) { return 1.0 / (1.0 + exp(-x)); }
+
+static bool report(const char* name, const error_t& err, double abs_bound,
+                   double rel_bound)
+{
+  bool pass = err.abs_err <= abs_bound && err.rel_err <= rel_bound;
+  printf("%-8s max abs err %.3g (x = %.9g), max rel err %.3g (x = %.9g) %s\n",
+         name, err.abs_err, err.abs_at, err.rel_err, err.rel_at,
+         pass ? "ok" : "FAIL");
+  return pass;
+}
+
+// ns per element of a pass over the inputs, the way the vector engine's span
+// kernels (relay_vector_sigmoid/_tanh) run them
+template <class F>
+static double time_pass(F f, const std::vector<uint32_t>& in,
+                        std::vector<uint32_t>& out)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < in.size(); i++) {
+    out[i] = f(in[i]);
+  }
+  auto ns = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+  // keep the results alive
+  volatile uint32_t sink = out[in.size() / 2];
+  (void)sink;
+  return ns / in.size();
+}
+
+// best of TIMING_RUNS for fast and libm, alternating so that both see the
+// same load on the host
+template <class F, class G>
+static void time_ns(F fast, G libm, const std::vector<uint32_t>& in,
+                    double& fast_ns, double& libm_ns)
+{
+  std::vector<uint32_t> out(in.size());
+  for (int run = 0; run < TIMING_RUNS; run++) {
+    double f = time_pass(fast, in, out), l = time_pass(libm, in, out);
+    fast_ns = (run == 0) ? f : std::min(fast_ns, f);
+    libm_ns = (run == 0) ? l : std::min(libm_ns, l);
+  }
+}
+
+static bool report_speed(const char* name, double fast, double libm,
+                         double min_speedup)
+{
+  bool pass = libm / fast >= min_speedup;
+  printf("%-8s %.2f ns vs libm %.2f ns (%.2fx, min %.2fx) %s\n", name, fast,
+         libm, libm / fast, min_speedup, pass ? "ok" : "FAIL");
+  return pass;
+}
+
+static uint32_t libm_sigmoid(uint32_t w)
+{
+  return float_to_word(1.0 / (exp(-word_to_float(w)) + 1));
+}
+
+static uint32_t libm_tanh(uint32_t w)
+{
+  return float_to_word(tanh(word_to_float(w)));
+}
+
+int main()
+{
+  error_t tanh_err, sigmoid_err;
+  for (uint64_t bits = 0; bits <= 0xFFFFFFFFull; bits += SWEEP_STRIDE) {
+    float x = word_to_float((uint32_t)bits);
+    if (!isfinite(x)) {
+      continue;
+    }
+    tanh_err.add(x, word_to_float(fp_tanh((uint32_t)bits)), tanh((double)x));
+    sigmoid_err.add(x, word_to_float(fp_sigmoid((uint32_t)bits)),
+                    ref_sigmoid(x));
+  }
+
+  bool pass = report("tanh", tanh_err, TANH_MAX_ABS_ERR, TANH_MAX_REL_ERR);
+  pass &= report("sigmoid", sigmoid_err, SIGMOID_MAX_ABS_ERR,
+                 SIGMOID_MAX_REL_ERR);
+
+  // the LSTM operating range
+  std::vector<uint32_t> in;
+  for (int i = 0; i < TIMING_INPUTS; i++) {
+    in.push_back(float_to_word(-16.0f + 32.0f * i / TIMING_INPUTS));
+  }
+  double fast_ns, libm_ns;
+  time_ns(fp_tanh, libm_tanh, in, fast_ns, libm_ns);
+  pass &= report_speed("tanh", fast_ns, libm_ns, TANH_MIN_SPEEDUP);
+  time_ns(fp_sigmoid, libm_sigmoid, in, fast_ns, libm_ns);
+  pass &= report_speed("sigmoid", fast_ns, libm_ns, SIGMOID_MIN_SPEEDUP);
+
+  return pass ? 0 : 1;
+}
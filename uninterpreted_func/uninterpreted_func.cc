@@ -1,58 +1,180 @@
 #include "systemc.h"
 #include "relay.h"
+#include "relay_uf_kernels.h"
 #include <iostream>
 #include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 // floating point number
 #define DATA_BW 32
 #define DATA_BYTES 4
 
+// must match RELAY_NN_DENSE_DOT_TILE in relay_nn_dense.h
+#define DOT_TILE 16
+
+// must match RELAY_VECTOR_OP_TILE in relay_vector_op.h
+#define VECTOR_TILE 16
+
+// adpfloat8, must match MAXPOOLING_LANES in relay_maxpooling.h
+#define ADPFLOAT_BW 8
+#define ADPFLOAT_LANES 16
+
 /** floating point operations **/
 sc_biguint<DATA_BW> relay::bv_tanh(sc_biguint<DATA_BW> op0)
 {
-  unsigned int i = op0.to_uint();
-  float f = (*(float*)&i);
-  float res = tanh(f);
-  int ires = *(int*)&res;
-  // printf("bvtanh 0x%08x (%.6f) = 0x%08x (%.6f)\n", i, f, ires, res);
-  return ires;
+  uint32_t res = fp_tanh(op0.to_uint());
+  // printf("bvtanh 0x%08x = 0x%08x\n", op0.to_uint(), res);
+  return res;
 }
 
 sc_biguint<DATA_BW> relay::bv_sigmoid(sc_biguint<DATA_BW> op0)
 {
-  unsigned int i = op0.to_uint();
-  float f = (*(float*)&i);
-  float res = 1.0/(exp(-f) + 1);
-  int ires = *(int*)&res;
-  // printf("bvsig 0x%08x (%.6f) = 0x%08x (%.6f)\n", i, f, ires, res);
-  return ires;
+  uint32_t res = fp_sigmoid(op0.to_uint());
+  // printf("bvsig 0x%08x = 0x%08x\n", op0.to_uint(), res);
+  return res;
 }
 
 sc_biguint<DATA_BW> relay::bv_add(sc_biguint<DATA_BW> op0, sc_biguint<DATA_BW> op1)
 {
-  unsigned int i0 = op0.to_uint(), i1 = op1.to_uint();
-  float f0 = (*(float*)&i0), f1 = (*(float*)&i1);
-  
-  float res = f0 + f1;
-  unsigned int ires = *(int*)&res;
-  // printf("bvadd 0x%08x (%.6f) + 0x%08x (%.6f) = 0x%08x (%.6f)\n", i0, f0, i1, f1, ires, res);
-  return ires;
+  uint32_t res = fp_add(op0.to_uint(), op1.to_uint());
+  // printf("bvadd 0x%08x + 0x%08x = 0x%08x\n", op0.to_uint(), op1.to_uint(), res);
+  return res;
 }
 
 sc_biguint<DATA_BW> relay::bv_multiply(sc_biguint<DATA_BW> op0, sc_biguint<DATA_BW> op1)
 {
-  unsigned int i0 = op0.to_uint(), i1 = op1.to_uint();
-  float f0 = (*(float*)&i0), f1 = (*(float*)&i1);
-  
-  float res = f0 * f1;
-  unsigned int ires = *(int*)&res;
-  // printf("bvmul 0x%08x (%.6f) * 0x%08x (%.6f) = 0x%08x (%.6f)\n", i0, f0, i1, f1, ires, res);
-  return ires;
+  uint32_t res = fp_multiply(op0.to_uint(), op1.to_uint());
+  // printf("bvmul 0x%08x * 0x%08x = 0x%08x\n", op0.to_uint(), op1.to_uint(), res);
+  return res;
+}
+
+// op0 * op1 + op2 rounded once, as the accelerator's MAC does
+sc_biguint<DATA_BW> relay::bv_fma(sc_biguint<DATA_BW> op0, sc_biguint<DATA_BW> op1, sc_biguint<DATA_BW> op2)
+{
+  uint32_t res = fp_fma(op0.to_uint(), op1.to_uint(), op2.to_uint());
+  // printf("bvfma 0x%08x * 0x%08x + 0x%08x = 0x%08x\n", op0.to_uint(), op1.to_uint(), op2.to_uint(), res);
+  return res;
+}
+
+/** dot product over one dense tile **/
+static float dot_tile(const float* w, const float* x)
+{
+#if defined(UF_AVX2)
+  __m256 acc = _mm256_setzero_ps();
+  for (int k = 0; k < DOT_TILE; k += 8) {
+    acc = _mm256_fmadd_ps(_mm256_loadu_ps(w + k), _mm256_loadu_ps(x + k), acc);
+  }
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc),
+                          _mm256_extractf128_ps(acc, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  return _mm_cvtss_f32(sum);
+#elif defined(UF_NEON)
+  float32x4_t acc = vdupq_n_f32(0.0f);
+  for (int k = 0; k < DOT_TILE; k += 4) {
+    acc = vfmaq_f32(acc, vld1q_f32(w + k), vld1q_f32(x + k));
+  }
+  return vaddvq_f32(acc);
+#else
+  // four independent partial sums so the compiler can vectorize it
+  float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (int k = 0; k < DOT_TILE; k += 4) {
+    for (int l = 0; l < 4; l++) {
+      acc[l] += w[k + l] * x[k + l];
+    }
+  }
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
 }
 
-sc_biguint<8> relay::relay_adpfloat_max(sc_biguint<8> arg_0, sc_biguint<8> arg_1) {
+sc_biguint<DATA_BW> relay::bv_dot_product(sc_biguint<DATA_BW * DOT_TILE> op0,
+                                          sc_biguint<DATA_BW * DOT_TILE> op1)
+{
+  float w[DOT_TILE], x[DOT_TILE];
+  for (int k = 0; k < DOT_TILE; k++) {
+    w[k] = word_to_float(op0.range(DATA_BW * k + DATA_BW - 1, DATA_BW * k).to_uint());
+    x[k] = word_to_float(op1.range(DATA_BW * k + DATA_BW - 1, DATA_BW * k).to_uint());
+  }
+  uint32_t res = float_to_word(dot_tile(w, x));
+  // printf("bvdot = 0x%08x\n", res);
+  return res;
+}
+
+/** element-wise ops over one vector engine tile **/
+static void unpack_tile(const sc_biguint<DATA_BW * VECTOR_TILE>& tile,
+                        uint32_t* words)
+{
+  for (int k = 0; k < VECTOR_TILE; k++) {
+    words[k] = tile.range(DATA_BW * k + DATA_BW - 1, DATA_BW * k).to_uint();
+  }
+}
+
+static sc_biguint<DATA_BW * VECTOR_TILE> pack_tile(const uint32_t* words)
+{
+  sc_biguint<DATA_BW * VECTOR_TILE> tile = 0;
+  for (int k = 0; k < VECTOR_TILE; k++) {
+    tile.range(DATA_BW * k + DATA_BW - 1, DATA_BW * k) = words[k];
+  }
+  return tile;
+}
 
-  sc_biguint<8> result = 0;
+sc_biguint<DATA_BW * VECTOR_TILE> relay::bv_add_tile(sc_biguint<DATA_BW * VECTOR_TILE> op0,
+                                                     sc_biguint<DATA_BW * VECTOR_TILE> op1)
+{
+  uint32_t a[VECTOR_TILE], b[VECTOR_TILE], res[VECTOR_TILE];
+  unpack_tile(op0, a);
+  unpack_tile(op1, b);
+  relay_vector_add(a, b, res, VECTOR_TILE);
+  return pack_tile(res);
+}
+
+sc_biguint<DATA_BW * VECTOR_TILE> relay::bv_multiply_tile(sc_biguint<DATA_BW * VECTOR_TILE> op0,
+                                                          sc_biguint<DATA_BW * VECTOR_TILE> op1)
+{
+  uint32_t a[VECTOR_TILE], b[VECTOR_TILE], res[VECTOR_TILE];
+  unpack_tile(op0, a);
+  unpack_tile(op1, b);
+  relay_vector_multiply(a, b, res, VECTOR_TILE);
+  return pack_tile(res);
+}
+
+sc_biguint<DATA_BW * VECTOR_TILE> relay::bv_sigmoid_tile(sc_biguint<DATA_BW * VECTOR_TILE> op0)
+{
+  uint32_t a[VECTOR_TILE], res[VECTOR_TILE];
+  unpack_tile(op0, a);
+  relay_vector_sigmoid(a, res, VECTOR_TILE);
+  return pack_tile(res);
+}
+
+sc_biguint<DATA_BW * VECTOR_TILE> relay::bv_tanh_tile(sc_biguint<DATA_BW * VECTOR_TILE> op0)
+{
+  uint32_t a[VECTOR_TILE], res[VECTOR_TILE];
+  unpack_tile(op0, a);
+  relay_vector_tanh(a, res, VECTOR_TILE);
+  return pack_tile(res);
+}
+
+sc_biguint<ADPFLOAT_BW> relay::relay_adpfloat_max(sc_biguint<ADPFLOAT_BW> arg_0, sc_biguint<ADPFLOAT_BW> arg_1)
+{
+  return adpfloat_max(arg_0.to_uint(), arg_1.to_uint());
+}
+
+sc_biguint<ADPFLOAT_BW * ADPFLOAT_LANES>
+relay::relay_adpfloat_max_16(sc_biguint<ADPFLOAT_BW * ADPFLOAT_LANES> arg_0,
+                             sc_biguint<ADPFLOAT_BW * ADPFLOAT_LANES> arg_1)
+{
+  uint8_t a[ADPFLOAT_LANES], b[ADPFLOAT_LANES], max[ADPFLOAT_LANES];
+  for (int k = 0; k < ADPFLOAT_LANES; k++) {
+    a[k] = arg_0.range(ADPFLOAT_BW * k + ADPFLOAT_BW - 1, ADPFLOAT_BW * k).to_uint();
+    b[k] = arg_1.range(ADPFLOAT_BW * k + ADPFLOAT_BW - 1, ADPFLOAT_BW * k).to_uint();
+  }
+  relay_adpfloat_max_row(a, b, max, ADPFLOAT_LANES);
 
+  sc_biguint<ADPFLOAT_BW * ADPFLOAT_LANES> result = 0;
+  for (int k = 0; k < ADPFLOAT_LANES; k++) {
+    result.range(ADPFLOAT_BW * k + ADPFLOAT_BW - 1, ADPFLOAT_BW * k) = max[k];
+  }
   return result;
 }